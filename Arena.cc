@@ -0,0 +1,105 @@
+/*
+ * Arena.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <cstdlib>
+#include <sys/mman.h>
+
+#include "Arena.hh"
+#include "RSstats.hh"
+
+using namespace std;
+
+Arena::Arena(void) :
+        m_data(NULL), m_size(0), m_used(0), m_mapped(false) {
+}
+
+Arena::Arena(size_t size, bool hugePages) :
+        m_data(NULL), m_size(0), m_used(0), m_mapped(false) {
+    if (size == 0) {
+        return;
+    }
+    if (hugePages) {
+        size_t mapSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        p = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (p == MAP_FAILED) {
+            p = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+            if (p != MAP_FAILED) {
+                madvise(p, mapSize, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        if (p != MAP_FAILED) {
+            m_data = (unsigned char *) p;
+            m_size = mapSize;
+            m_mapped = true;
+            RSstats::add(RSstats::e_rs_stat_allocations);
+            RSstats::add(RSstats::e_rs_stat_allocated_bytes, m_size);
+            return;
+        }
+    }
+    void *p = NULL;
+    if (posix_memalign(&p, ALIGNMENT, bytes(size)) == 0) {
+        m_data = (unsigned char *) p;
+        m_size = bytes(size);
+        RSstats::add(RSstats::e_rs_stat_allocations);
+        RSstats::add(RSstats::e_rs_stat_allocated_bytes, m_size);
+    }
+}
+
+Arena::~Arena() {
+    release();
+}
+
+Arena::Arena(Arena &&a) :
+        m_data(a.m_data), m_size(a.m_size), m_used(a.m_used), m_mapped(a.m_mapped) {
+    a.m_data = NULL;
+    a.m_size = 0;
+    a.m_used = 0;
+}
+
+Arena& Arena::operator=(Arena &&a) {
+    if (this != &a) {
+        release();
+        m_data = a.m_data;
+        m_size = a.m_size;
+        m_used = a.m_used;
+        m_mapped = a.m_mapped;
+        a.m_data = NULL;
+        a.m_size = 0;
+        a.m_used = 0;
+    }
+    return *this;
+}
+
+void* Arena::alloc(size_t size, size_t count) {
+    size_t n = bytes(size, count);
+    if (m_data == NULL || n > m_size - m_used) {
+        return NULL;
+    }
+    void *p = m_data + m_used;
+    m_used += n;
+    return p;
+}
+
+void Arena::release(void) {
+    if (m_data == NULL) {
+        return;
+    }
+    if (m_mapped) {
+        munmap(m_data, m_size);
+    } else {
+        free(m_data);
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_used = 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Arena.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef ARENA_HH_
+#define ARENA_HH_
+
+#include <cstddef>
+
+/* One 64-byte aligned memory block, carved into the buffers of an object
+ * with alloc(), so the object makes a single allocation.
+ * With hugePages the block is mapped from huge pages (MAP_HUGETLB), or if
+ * none are reserved, from ordinary pages advised to become transparent huge
+ * pages. The block is released as a whole by the destructor.
+ *  */
+class Arena {
+public:
+    static const size_t ALIGNMENT = 64;
+    static const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+public:
+    Arena(void);
+    Arena(size_t size, bool hugePages = false);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena& operator=(const Arena &) = delete;
+    Arena(Arena &&a);
+    Arena& operator=(Arena &&a);
+
+    /* Next count x size bytes of the block (aligned), NULL if it is used up */
+    void* alloc(size_t size, size_t count = 1);
+    template<typename U>
+    inline U* alloc(size_t count) {
+        return (U *) alloc(sizeof(U), count);
+    }
+    /* Bytes of count x size aligned buffers, for the size of the block */
+    static inline size_t bytes(size_t size, size_t count = 1) {
+        return (size * count + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    inline void* data(void) const {
+        return m_data;
+    }
+    inline size_t size(void) const {
+        return m_size;
+    }
+    inline bool hugePages(void) const {
+        return m_mapped;
+    }
+
+private:
+    void release(void);
+
+private:
+    unsigned char *m_data;
+    size_t m_size;
+    size_t m_used;
+    bool m_mapped;                      /* mmap'ed (huge pages) or posix_memalign'ed */
+};
+
+#endif /* ARENA_HH_ */
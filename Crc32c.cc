@@ -0,0 +1,120 @@
+/*
+ * Crc32c.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <cstring>
+
+#include "Crc32c.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const uint32_t POLY = 0x82F63B78;        /* 0x1EDC6F41 reflected */
+
+/* m_tbl[k][b]: crc of byte b followed by k zero bytes */
+struct _TABLE {
+    uint32_t m_tbl[8][256];
+    _TABLE() {
+        for (unsigned int b = 0; b < 256; ++b) {
+            uint32_t c = b;
+            for (unsigned int i = 0; i < 8; ++i) {
+                c = (c >> 1) ^ ((c & 1) ? POLY : 0);
+            }
+            m_tbl[0][b] = c;
+        }
+        for (unsigned int b = 0; b < 256; ++b) {
+            for (unsigned int k = 1; k < 8; ++k) {
+                m_tbl[k][b] = (m_tbl[k - 1][b] >> 8) ^ m_tbl[0][m_tbl[k - 1][b] & 0xff];
+            }
+        }
+    }
+};
+
+static const _TABLE& table(void) {
+    static const _TABLE s_table;
+    return s_table;
+}
+
+static uint32_t crcTable(uint32_t crc, const unsigned char *data, size_t len) {
+    const uint32_t (*t)[256] = table().m_tbl;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, data + i, 4);
+        memcpy(&hi, data + i + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff]
+                ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff]
+                ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; i < len; ++i) {
+        crc = (crc >> 8) ^ t[0][(crc ^ data[i]) & 0xff];
+    }
+    return crc;
+}
+
+#ifdef CRC32C_X86
+__attribute__((target("sse4.2")))
+static uint32_t crcSse42(uint32_t crc, const unsigned char *data, size_t len) {
+    size_t i = 0;
+#ifdef __x86_64__
+    unsigned long long c = crc;
+    for (; i + 8 <= len; i += 8) {
+        unsigned long long v;
+        memcpy(&v, data + i, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    crc = (uint32_t) c;
+#endif
+    for (; i + 4 <= len; i += 4) {
+        unsigned int v;
+        memcpy(&v, data + i, 4);
+        crc = _mm_crc32_u32(crc, v);
+    }
+    for (; i < len; ++i) {
+        crc = _mm_crc32_u8(crc, data[i]);
+    }
+    return crc;
+}
+
+static bool hasSse42(void) {
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 20)) != 0;
+}
+#endif
+
+typedef uint32_t (*CRC_FUNC)(uint32_t crc, const unsigned char *data, size_t len);
+
+/* crc kernel singleton */
+static CRC_FUNC getCrcFunc(void) {
+    static const CRC_FUNC s_crc =
+#ifdef CRC32C_X86
+            hasSse42() ? crcSse42 :
+#endif
+            crcTable;
+    return s_crc;
+}
+
+uint32_t Crc32c::extend(uint32_t crc, const unsigned char *data, size_t len) {
+    return ~getCrcFunc()(~crc, data, len);
+}
+
+uint32_t Crc32c::extendTable(uint32_t crc, const unsigned char *data, size_t len) {
+    return ~crcTable(~crc, data, len);
+}
+
+bool Crc32c::hardware(void) {
+    return getCrcFunc() != crcTable;
+}
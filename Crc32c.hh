@@ -0,0 +1,31 @@
+/*
+ * Crc32c.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef CRC32C_HH_
+#define CRC32C_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+/* CRC-32C (Castagnoli, polynomial 0x1EDC6F41, reflected) of shards.
+ * extend() continues the checksum of the bytes before, so a shard can be
+ * checksummed tile by tile while its tiles are in cache:
+ * crc(a + b) = extend(extend(0, a), b).
+ * The crc32 instruction of SSE4.2 is used when the CPU has it, otherwise
+ * a slicing-by-8 table.
+ *  */
+class Crc32c {
+public:
+    static std::uint32_t extend(std::uint32_t crc, const unsigned char *data,
+            size_t len);
+    /* The table version, whatever the CPU */
+    static std::uint32_t extendTable(std::uint32_t crc, const unsigned char *data,
+            size_t len);
+    /* extend uses the crc32 instruction */
+    static bool hardware(void);
+};
+
+#endif /* CRC32C_HH_ */
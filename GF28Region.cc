@@ -0,0 +1,396 @@
+/*
+ * GF28Region.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <cstring>
+
+#include "GF28Value.hh"
+#include "GF28Region.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GF28_REGION_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/* s_nibbleTbl[c][n] = c * n, s_nibbleTbl[c][16 + n] = c * (n << 4) (0 <= n <= 15) */
+static unsigned char s_nibbleTbl[256][32] __attribute__((aligned(64)));
+/* s_affineTbl[c]: 8x8 bit matrix of x -> c * x for gf2p8affineqb */
+static unsigned long long s_affineTbl[256];
+
+static void buildTables(void) {
+    for (unsigned int c = 0; c < 256; ++c) {
+        for (unsigned int n = 0; n < 16; ++n) {
+            s_nibbleTbl[c][n] = (GF28Value(c) * GF28Value(n)).value();
+            s_nibbleTbl[c][16 + n] = (GF28Value(c) * GF28Value(n << 4)).value();
+        }
+        /* bit i of the result is parity(x & row(i)), row(i) is stored in byte (7 - i) */
+        unsigned long long m = 0;
+        for (unsigned int i = 0; i < 8; ++i) {
+            unsigned long long row = 0;
+            for (unsigned int j = 0; j < 8; ++j) {
+                if (((GF28Value(c) * GF28Value(1u << j)).value() >> i) & 1) {
+                    row |= 1ull << j;
+                }
+            }
+            m |= row << (8 * (7 - i));
+        }
+        s_affineTbl[c] = m;
+    }
+}
+
+/* Scalar kernel */
+template<bool ADD>
+static void regionScalar(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const unsigned char *tbl = s_nibbleTbl[c];
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char p = tbl[src[i] & 0x0f] ^ tbl[16 + (src[i] >> 4)];
+        dst[i] = ADD ? (dst[i] ^ p) : p;
+    }
+}
+
+static void dotProductScalar(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    if (n == 0) {
+        memset(dst, 0, len);
+        return;
+    }
+    regionScalar<false>(dst, src[0] + offset, c[0], len);
+    for (unsigned int k = 1; k < n; ++k) {
+        regionScalar<true>(dst, src[k] + offset, c[k], len);
+    }
+}
+
+#ifdef GF28_REGION_X86
+/* SSSE3 kernel: 16 bytes per pshufb pair */
+template<bool ADD>
+__attribute__((target("ssse3")))
+static void regionSsse3(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const __m128i lo = _mm_load_si128((const __m128i *) s_nibbleTbl[c]);
+    const __m128i hi = _mm_load_si128((const __m128i *) (s_nibbleTbl[c] + 16));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i p = _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        if (ADD) {
+            p = _mm_xor_si128(p, _mm_loadu_si128((const __m128i *) (dst + i)));
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), p);
+    }
+    regionScalar<ADD>(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("ssse3")))
+static void dotProductSsse3(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i p = _mm_setzero_si128();
+        for (unsigned int k = 0; k < n; ++k) {
+            const __m128i lo = _mm_load_si128((const __m128i *) s_nibbleTbl[c[k]]);
+            const __m128i hi = _mm_load_si128((const __m128i *) (s_nibbleTbl[c[k]] + 16));
+            __m128i x = _mm_loadu_si128((const __m128i *) (src[k] + offset + i));
+            p = _mm_xor_si128(p, _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)));
+            p = _mm_xor_si128(p, _mm_shuffle_epi8(hi,
+                    _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), p);
+    }
+    dotProductScalar(dst + i, src, offset + i, c, n, len - i);
+}
+
+/* AVX2 kernel: 32 bytes per vpshufb pair */
+template<bool ADD>
+__attribute__((target("avx2")))
+static void regionAvx2(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const __m256i lo = _mm256_broadcastsi128_si256(
+            _mm_load_si128((const __m128i *) s_nibbleTbl[c]));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+            _mm_load_si128((const __m128i *) (s_nibbleTbl[c] + 16)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i p = _mm256_xor_si256(
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        if (ADD) {
+            p = _mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *) (dst + i)));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    regionScalar<ADD>(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx2")))
+static void dotProductAvx2(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i p = _mm256_setzero_si256();
+        for (unsigned int k = 0; k < n; ++k) {
+            const __m256i lo = _mm256_broadcastsi128_si256(
+                    _mm_load_si128((const __m128i *) s_nibbleTbl[c[k]]));
+            const __m256i hi = _mm256_broadcastsi128_si256(
+                    _mm_load_si128((const __m128i *) (s_nibbleTbl[c[k]] + 16)));
+            __m256i x = _mm256_loadu_si256((const __m256i *) (src[k] + offset + i));
+            p = _mm256_xor_si256(p, _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)));
+            p = _mm256_xor_si256(p, _mm256_shuffle_epi8(hi,
+                    _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    dotProductScalar(dst + i, src, offset + i, c, n, len - i);
+}
+
+/* AVX2 + GFNI kernel: 32 bytes per vgf2p8affineqb */
+template<bool ADD>
+__attribute__((target("avx2,gfni")))
+static void regionAvx2Gfni(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const __m256i m = _mm256_set1_epi64x((long long) s_affineTbl[c]);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i p = _mm256_gf2p8affine_epi64_epi8(
+                _mm256_loadu_si256((const __m256i *) (src + i)), m, 0);
+        if (ADD) {
+            p = _mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *) (dst + i)));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    regionScalar<ADD>(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx2,gfni")))
+static void dotProductAvx2Gfni(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i p = _mm256_setzero_si256();
+        for (unsigned int k = 0; k < n; ++k) {
+            const __m256i m = _mm256_set1_epi64x((long long) s_affineTbl[c[k]]);
+            p = _mm256_xor_si256(p, _mm256_gf2p8affine_epi64_epi8(
+                    _mm256_loadu_si256((const __m256i *) (src[k] + offset + i)), m, 0));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    dotProductScalar(dst + i, src, offset + i, c, n, len - i);
+}
+
+/* The unmasked _mm512_broadcast_i32x4 and _mm512_srli_epi64 pass an
+ * undefined register as their merge operand, which -O2 reports as
+ * uninitialized: the zero-masking forms with a full mask are the same
+ * instructions without it */
+__attribute__((target("avx512f")))
+static inline __m512i broadcastTbl512(const unsigned char *p) {
+    return _mm512_maskz_broadcast_i32x4((__mmask16) 0xffff,
+            _mm_load_si128((const __m128i *) p));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i highNibbles512(__m512i x, __m512i mask) {
+    return _mm512_and_si512(_mm512_maskz_srli_epi64((__mmask8) 0xff, x, 4), mask);
+}
+
+/* AVX-512 kernel: 64 bytes per vpshufb pair */
+template<bool ADD>
+__attribute__((target("avx512f,avx512bw")))
+static void regionAvx512(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const __m512i lo = broadcastTbl512(s_nibbleTbl[c]);
+    const __m512i hi = broadcastTbl512(s_nibbleTbl[c] + 16);
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i x = _mm512_loadu_si512((const void *) (src + i));
+        __m512i p = _mm512_xor_si512(
+                _mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+                _mm512_shuffle_epi8(hi, highNibbles512(x, mask)));
+        if (ADD) {
+            p = _mm512_xor_si512(p, _mm512_loadu_si512((const void *) (dst + i)));
+        }
+        _mm512_storeu_si512((void *) (dst + i), p);
+    }
+    regionScalar<ADD>(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void dotProductAvx512(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i p = _mm512_setzero_si512();
+        for (unsigned int k = 0; k < n; ++k) {
+            const __m512i lo = broadcastTbl512(s_nibbleTbl[c[k]]);
+            const __m512i hi = broadcastTbl512(s_nibbleTbl[c[k]] + 16);
+            __m512i x = _mm512_loadu_si512((const void *) (src[k] + offset + i));
+            p = _mm512_xor_si512(p, _mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)));
+            p = _mm512_xor_si512(p, _mm512_shuffle_epi8(hi,
+                    highNibbles512(x, mask)));
+        }
+        _mm512_storeu_si512((void *) (dst + i), p);
+    }
+    dotProductScalar(dst + i, src, offset + i, c, n, len - i);
+}
+
+/* AVX-512 + GFNI kernel: 64 bytes per vgf2p8affineqb */
+template<bool ADD>
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void regionAvx512Gfni(unsigned char *dst, const unsigned char *src,
+        unsigned char c, size_t len) {
+    const __m512i m = _mm512_set1_epi64((long long) s_affineTbl[c]);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i p = _mm512_gf2p8affine_epi64_epi8(
+                _mm512_loadu_si512((const void *) (src + i)), m, 0);
+        if (ADD) {
+            p = _mm512_xor_si512(p, _mm512_loadu_si512((const void *) (dst + i)));
+        }
+        _mm512_storeu_si512((void *) (dst + i), p);
+    }
+    regionScalar<ADD>(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void dotProductAvx512Gfni(unsigned char *dst,
+        const unsigned char * const *src, size_t offset,
+        const unsigned char *c, unsigned int n, size_t len) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i p = _mm512_setzero_si512();
+        for (unsigned int k = 0; k < n; ++k) {
+            const __m512i m = _mm512_set1_epi64((long long) s_affineTbl[c[k]]);
+            p = _mm512_xor_si512(p, _mm512_gf2p8affine_epi64_epi8(
+                    _mm512_loadu_si512((const void *) (src[k] + offset + i)), m, 0));
+        }
+        _mm512_storeu_si512((void *) (dst + i), p);
+    }
+    dotProductScalar(dst + i, src, offset + i, c, n, len - i);
+}
+
+static unsigned long long xgetbv0(void) {
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long) edx << 32) | eax;
+}
+#endif /* GF28_REGION_X86 */
+
+static const GF28Region::REGION_FUNC s_multiplyFunc[] = {
+        regionScalar<false>,
+#ifdef GF28_REGION_X86
+        regionSsse3<false>, regionAvx2<false>, regionAvx2Gfni<false>,
+        regionAvx512<false>, regionAvx512Gfni<false>,
+#else
+        NULL, NULL, NULL, NULL, NULL,
+#endif
+};
+static const GF28Region::REGION_FUNC s_multiplyAddFunc[] = {
+        regionScalar<true>,
+#ifdef GF28_REGION_X86
+        regionSsse3<true>, regionAvx2<true>, regionAvx2Gfni<true>,
+        regionAvx512<true>, regionAvx512Gfni<true>,
+#else
+        NULL, NULL, NULL, NULL, NULL,
+#endif
+};
+
+static_assert(GF28Region::e_gf28_kernel_max <= RSstats::KERNEL_SLOTS,
+        "RSstats counts the calls of every kernel");
+
+static const GF28Region::DOT_PRODUCT_FUNC s_dotProductFunc[] = {
+        dotProductScalar,
+#ifdef GF28_REGION_X86
+        dotProductSsse3, dotProductAvx2, dotProductAvx2Gfni,
+        dotProductAvx512, dotProductAvx512Gfni,
+#else
+        NULL, NULL, NULL, NULL, NULL,
+#endif
+};
+
+GF28Region::_KERNEL_TABLE::_KERNEL_TABLE() {
+    buildTables();
+    for (int i = 0; i < e_gf28_kernel_max; ++i) {
+        m_supported[i] = false;
+    }
+    m_supported[e_gf28_kernel_scalar] = true;
+#ifdef GF28_REGION_X86
+    unsigned int eax, ebx, ecx, edx;
+    bool ssse3 = false, osxsave = false, avx = false;
+    bool avx2 = false, avx512 = false, gfni = false;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        ssse3 = (ecx & (1u << 9)) != 0;
+        osxsave = (ecx & (1u << 27)) != 0;
+        avx = (ecx & (1u << 28)) != 0;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        avx2 = (ebx & (1u << 5)) != 0;
+        avx512 = (ebx & (1u << 16)) != 0 && (ebx & (1u << 30)) != 0; /* F + BW */
+        gfni = (ecx & (1u << 8)) != 0;
+    }
+    /* the OS must save the YMM (and opmask/ZMM) state */
+    unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    bool ymmState = (xcr0 & 0x06) == 0x06;
+    bool zmmState = (xcr0 & 0xe6) == 0xe6;
+    m_supported[e_gf28_kernel_ssse3] = ssse3;
+    m_supported[e_gf28_kernel_avx2] = avx && avx2 && ymmState;
+    m_supported[e_gf28_kernel_avx2_gfni] = m_supported[e_gf28_kernel_avx2] && gfni;
+    m_supported[e_gf28_kernel_avx512] = m_supported[e_gf28_kernel_avx2]
+            && avx512 && zmmState;
+    m_supported[e_gf28_kernel_avx512_gfni] = m_supported[e_gf28_kernel_avx512] && gfni;
+#endif
+    /* the best kernel is the last supported one */
+    m_kernel = e_gf28_kernel_scalar;
+    for (int i = 0; i < e_gf28_kernel_max; ++i) {
+        if (m_supported[i]) {
+            m_kernel = (E_GF28_KERNEL) i;
+        }
+    }
+    m_multiply = s_multiplyFunc[m_kernel];
+    m_multiplyAdd = s_multiplyAddFunc[m_kernel];
+    m_dotProduct = s_dotProductFunc[m_kernel];
+}
+
+bool GF28Region::isSupported(E_GF28_KERNEL kernel) {
+    if (kernel < 0 || kernel >= e_gf28_kernel_max) {
+        return false;
+    }
+    return getKernelTblIns()->m_supported[kernel];
+}
+
+bool GF28Region::setKernel(E_GF28_KERNEL kernel) {
+    if (!isSupported(kernel)) {
+        return false;
+    }
+    _KERNEL_TABLE *ins = getKernelTblIns();
+    ins->m_kernel = kernel;
+    ins->m_multiply = s_multiplyFunc[kernel];
+    ins->m_multiplyAdd = s_multiplyAddFunc[kernel];
+    ins->m_dotProduct = s_dotProductFunc[kernel];
+    return true;
+}
+
+const char* GF28Region::kernelName(E_GF28_KERNEL kernel) {
+    static const char *name[] = { "scalar", "ssse3", "avx2", "avx2-gfni",
+            "avx512", "avx512-gfni" };
+    if (kernel < 0 || kernel >= e_gf28_kernel_max) {
+        return "unknown";
+    }
+    return name[kernel];
+}
@@ -0,0 +1,102 @@
+/*
+ * GF28Region.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef GF28REGION_HH_
+#define GF28REGION_HH_
+
+#include <cstddef>
+
+#include "RSstats.hh"
+
+/* Region operations of GF(2^8): every byte of a buffer is multiplied by the
+ * same coefficient c.
+ * A byte x is split into its nibbles, c*x = c*(x & 0x0f) + c*(x & 0xf0),
+ * so two 16-entry tables per coefficient are enough and a whole vector
+ * register is looked up at once with pshufb (SSSE3, AVX2, AVX-512).
+ * Multiplying by c is also a linear map over GF(2), so on GFNI hosts it is a
+ * single gf2p8affineqb with an 8x8 bit matrix per coefficient.
+ * The fastest kernel supported by the CPU is selected once at startup from
+ * CPUID, the scalar (table lookup) kernel is the fallback.
+ *  */
+class GF28Region {
+public:
+    typedef enum {
+        e_gf28_kernel_scalar = 0,
+        e_gf28_kernel_ssse3,
+        e_gf28_kernel_avx2,
+        e_gf28_kernel_avx2_gfni,
+        e_gf28_kernel_avx512,
+        e_gf28_kernel_avx512_gfni,
+        e_gf28_kernel_max,
+    } E_GF28_KERNEL;
+
+    typedef unsigned char SYMBOL;               /* coefficient */
+    static const size_t SYMBOL_SIZE = 1;        /* bytes per symbol */
+
+    typedef void (*REGION_FUNC)(unsigned char *dst, const unsigned char *src,
+            unsigned char c, size_t len);
+    typedef void (*DOT_PRODUCT_FUNC)(unsigned char *dst,
+            const unsigned char * const *src, size_t offset,
+            const unsigned char *c, unsigned int n, size_t len);
+
+private:
+    class _KERNEL_TABLE {
+    public:
+        _KERNEL_TABLE();
+    public:
+        E_GF28_KERNEL m_kernel;                 /* selected kernel */
+        REGION_FUNC m_multiply;                 /* dst = c * src */
+        REGION_FUNC m_multiplyAdd;              /* dst ^= c * src */
+        DOT_PRODUCT_FUNC m_dotProduct;          /* dst = sum(c[k] * src[k]) */
+        bool m_supported[e_gf28_kernel_max];    /* kernels the CPU can run */
+    };
+
+public:
+    /* kernel table singleton (needing c++11) */
+    static inline _KERNEL_TABLE* getKernelTblIns(void) {
+        static _KERNEL_TABLE s_kernel_tbl;
+        return &s_kernel_tbl;
+    }
+    /* dst[i] = c * src[i] (0 <= i < len) */
+    static inline void multiply(unsigned char *dst, const unsigned char *src,
+            unsigned char c, size_t len) {
+        const _KERNEL_TABLE *ins = getKernelTblIns();
+        RSstats::kernelCall(ins->m_kernel);
+        ins->m_multiply(dst, src, c, len);
+    }
+    /* dst[i] ^= c * src[i] (0 <= i < len) */
+    static inline void multiplyAdd(unsigned char *dst,
+            const unsigned char *src, unsigned char c, size_t len) {
+        if (c != 0) {
+            const _KERNEL_TABLE *ins = getKernelTblIns();
+            RSstats::kernelCall(ins->m_kernel);
+            ins->m_multiplyAdd(dst, src, c, len);
+        }
+    }
+
+    /* dst[i] = c[0] * src[0][offset + i] + ... + c[n-1] * src[n-1][offset + i]
+     * (0 <= i < len)
+     * The sum is kept in a register, so every source byte is read once
+     * and every destination byte is written once. */
+    static inline void dotProduct(unsigned char *dst,
+            const unsigned char * const *src, size_t offset,
+            const unsigned char *c, unsigned int n, size_t len) {
+        const _KERNEL_TABLE *ins = getKernelTblIns();
+        RSstats::kernelCall(ins->m_kernel);
+        ins->m_dotProduct(dst, src, offset, c, n, len);
+    }
+
+    static E_GF28_KERNEL kernel(void) {
+        return getKernelTblIns()->m_kernel;
+    }
+    static bool isSupported(E_GF28_KERNEL kernel);
+    /* Force a kernel (for testing and benchmarking), returns false if the CPU
+     * can not run it. */
+    static bool setKernel(E_GF28_KERNEL kernel);
+    static const char* kernelName(E_GF28_KERNEL kernel);
+};
+
+#endif /* GF28REGION_HH_ */
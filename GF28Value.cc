@@ -11,10 +11,6 @@
 
 using namespace std;
 
-unsigned int GF28Value::_MULTIPLICATION_TABLE::s_forwardTbl[256] = { };
-unsigned int GF28Value::_MULTIPLICATION_TABLE::s_backwardTbl[256] = { };
-unsigned int GF28Value::_MULTIPLICATION_TABLE::s_reverseTbl[256] = { };
-
 void GF28Value::_MULTIPLICATION_TABLE::debug(void) const {
     std::streamsize w = cout.width();
     cout.width(2);
@@ -25,7 +21,7 @@ void GF28Value::_MULTIPLICATION_TABLE::debug(void) const {
     cout << "forward table:" << endl;
     for (int i = 0; i < 256; ++i) {
         cout.width(2);
-        cout << s_forwardTbl[i] << " ";
+        cout << (unsigned int) GF28_EXP_TABLE::s_expTbl[i] << " ";
         if (i % 16 == 15) {
             cout << endl;
         }
@@ -33,7 +29,7 @@ void GF28Value::_MULTIPLICATION_TABLE::debug(void) const {
     cout << "backward table:" << endl;
     for (int i = 0; i < 256; ++i) {
         cout.width(2);
-        cout << s_backwardTbl[i] << " ";
+        cout << (unsigned int) GF28_LOG_TABLE::s_logTbl[i] << " ";
         if (i % 16 == 15) {
             cout << endl;
         }
@@ -41,17 +37,17 @@ void GF28Value::_MULTIPLICATION_TABLE::debug(void) const {
     cout << "reverse table:" << endl;
     for (int i = 0; i < 256; ++i) {
         cout.width(2);
-        cout << s_backwardTbl[i] << " ";
+        cout << (unsigned int) GF28_INVERSE_TABLE::s_inverseTbl[i] << " ";
         if (i % 16 == 15) {
             cout << endl;
         }
     }
     for (unsigned int i = 0; i < 255; ++i) {
-        if (s_backwardTbl[s_forwardTbl[i]] != i) {
+        if (getBackward(getForward(i)) != i) {
             cout << "forward/backward table error at index(" << i << ")."
                     << endl;
         }
-        if (GF28Value(s_reverseTbl[i + 1]) * GF28Value(i + 1) != GF28Value(1)) {
+        if (GF28Value(getReverse(i + 1)) * GF28Value(i + 1) != GF28Value(1)) {
             cout << "reverse table error at index(" << i + 1 << ")." << endl;
         }
     }
@@ -10,60 +10,122 @@
 
 #include <iostream>
 
+#include "GF28Region.hh"
+
+/* GF(2^8) tables generated at compile time (c++11 constexpr) */
+#define GF28_PRIME_POLYNOMIALS 0x11D                /* x^8 + x^4 + x^3 +x +1 */
+
+/* g^(k+1) from g^k, g(generator): x */
+constexpr unsigned int gf28Next(unsigned int v) {
+    return ((v << 1) & 0x100) ? ((v << 1) ^ GF28_PRIME_POLYNOMIALS) : (v << 1);
+}
+/* g^k (0 <= k <= 254) */
+constexpr unsigned int gf28Exp(unsigned int k) {
+    return (k == 0) ? 1 : gf28Next(gf28Exp(k - 1));
+}
+/* k of g^k = v (1 <= v <= 255), searching from k */
+constexpr unsigned int gf28Log(unsigned int v, unsigned int k = 0) {
+    return (k >= 255) ? 0 : ((gf28Exp(k) == v) ? k : gf28Log(v, k + 1));
+}
+
+/* Index sequences 0, ..., N-1 made by halves, so that the 65536 entries of
+ * the product table do not need a deep template recursion */
+template<unsigned int... I> struct GF28Sequence {
+};
+template<typename S1, typename S2> struct GF28ConcatSequence;
+template<unsigned int... I1, unsigned int... I2>
+struct GF28ConcatSequence<GF28Sequence<I1...>, GF28Sequence<I2...> > {
+    typedef GF28Sequence<I1..., (sizeof...(I1) + I2)...> type;
+};
+template<unsigned int N> struct GF28MakeSequence {
+    typedef typename GF28ConcatSequence<typename GF28MakeSequence<N / 2>::type,
+            typename GF28MakeSequence<N - N / 2>::type>::type type;
+};
+template<> struct GF28MakeSequence<0> {
+    typedef GF28Sequence<> type;
+};
+template<> struct GF28MakeSequence<1> {
+    typedef GF28Sequence<0> type;
+};
+
+/* s_expTbl[k] = g^(k % 255) (0 <= k < 510), so that the sum of two
+ * logarithms needs no % 255 */
+template<typename S> struct GF28ExpTable;
+template<unsigned int... I> struct GF28ExpTable<GF28Sequence<I...> > {
+    static constexpr unsigned char s_expTbl[sizeof...(I)] = {
+            (unsigned char) gf28Exp(I % 255)... };
+};
+template<unsigned int... I>
+constexpr unsigned char GF28ExpTable<GF28Sequence<I...> >::s_expTbl[sizeof...(I)];
+/* s_logTbl[g^k] = k, s_logTbl[0] = 0 (unused) */
+template<typename S> struct GF28LogTable;
+template<unsigned int... I> struct GF28LogTable<GF28Sequence<I...> > {
+    static constexpr unsigned char s_logTbl[sizeof...(I)] = {
+            (unsigned char) gf28Log(I)... };
+};
+template<unsigned int... I>
+constexpr unsigned char GF28LogTable<GF28Sequence<I...> >::s_logTbl[sizeof...(I)];
+
+typedef GF28ExpTable<GF28MakeSequence<510>::type> GF28_EXP_TABLE;
+typedef GF28LogTable<GF28MakeSequence<256>::type> GF28_LOG_TABLE;
+
+/* s_inverseTbl[k] = e/k, s_inverseTbl[0] = 0 (unused) */
+template<typename S> struct GF28InverseTable;
+template<unsigned int... I> struct GF28InverseTable<GF28Sequence<I...> > {
+    static constexpr unsigned char s_inverseTbl[sizeof...(I)] = {
+            (unsigned char) ((I == 0) ? 0 :
+                    GF28_EXP_TABLE::s_expTbl[255 - GF28_LOG_TABLE::s_logTbl[I]])... };
+};
+template<unsigned int... I>
+constexpr unsigned char GF28InverseTable<GF28Sequence<I...> >::s_inverseTbl[sizeof...(I)];
+typedef GF28InverseTable<GF28MakeSequence<256>::type> GF28_INVERSE_TABLE;
+
+#ifdef GF28_PRODUCT_TABLE
+/* s_productTbl[(i << 8) | j] = i * j, 64KB, enabled by -DGF28_PRODUCT_TABLE */
+template<typename S> struct GF28ProductTable;
+template<unsigned int... I> struct GF28ProductTable<GF28Sequence<I...> > {
+    static constexpr unsigned char s_productTbl[sizeof...(I)] = {
+            (unsigned char) (((I >> 8) == 0 || (I & 0xff) == 0) ? 0 :
+                    GF28_EXP_TABLE::s_expTbl[GF28_LOG_TABLE::s_logTbl[I >> 8]
+                            + GF28_LOG_TABLE::s_logTbl[I & 0xff]])... };
+};
+template<unsigned int... I>
+constexpr unsigned char GF28ProductTable<GF28Sequence<I...> >::s_productTbl[sizeof...(I)];
+typedef GF28ProductTable<GF28MakeSequence<65536>::type> GF28_PRODUCT_TABLE_TYPE;
+#endif
+
 class GF28Value {
 private:
+    /* Checked access to the tables, kept for debugging */
     class _MULTIPLICATION_TABLE {
     public:
-        _MULTIPLICATION_TABLE() {
-            s_forwardTbl[0] = 1;                                /* g^0 = e */
-            for (int i = 1; i <= 254; ++i) {
-                s_forwardTbl[i] = (s_forwardTbl[i - 1] << 1);   /* g(generator): x */
-                if ((s_forwardTbl[i] & 0x100) != 0) {
-                    s_forwardTbl[i] ^= GF28_PRIME_POLYNOMIALS;
-                }
-            }
-            for (int i = 0; i <= 254; ++i) {
-                s_backwardTbl[s_forwardTbl[i]] = i;
-            }
-            for (int i = 1; i <= 255; ++i) {
-                /*    i * s_reverseTbl[i] = e
-                 * => g^k * g^(255-k) = e
-                 * => s_reverseTbl[i] = g^(255-k)
-                 *  */
-                int k = s_backwardTbl[i];                        /* calculate k */
-                s_reverseTbl[i] = s_forwardTbl[(255 - k) % 255]; /* s_reverseTbl[i] */
-            }
+        constexpr _MULTIPLICATION_TABLE() {
         }
-        inline unsigned int getForward(unsigned int i) {
+        inline unsigned int getForward(unsigned int i) const {
             if (i >= 255) {
                 return GF28_INVALID;
             }
-            return s_forwardTbl[i];
+            return GF28_EXP_TABLE::s_expTbl[i];
         }
-        inline unsigned int getBackward(unsigned int i) {
+        inline unsigned int getBackward(unsigned int i) const {
             if (i == 0 || i >= 256) {
                 return GF28_INVALID;
             }
-            return s_backwardTbl[i];
+            return GF28_LOG_TABLE::s_logTbl[i];
         }
-        inline unsigned int getReverse(unsigned int i) {
+        inline unsigned int getReverse(unsigned int i) const {
             if (i == 0 || i >= 256) {
                 return GF28_INVALID;
             }
-            return s_reverseTbl[i];
+            return GF28_INVERSE_TABLE::s_inverseTbl[i];
         }
     public:
         void debug(void) const;
-    private:
-        static const unsigned int GF28_INVALID = 0x100;
-        static const int GF28_PRIME_POLYNOMIALS = 0x11D;    /* x^8 + x^4 + x^3 +x +1 */
-        static unsigned int s_forwardTbl[256];              /* s_forwardTbl[k] = g^k :(1<=s_forwardTbl[k]<=255, 0<=k<=254) */
-        static unsigned int s_backwardTbl[256];             /* s_backwardTbl[g^k] = k (1<=g^k<=255, 0<=s_backwardTbl[g^k]<=254) */
-        static unsigned int s_reverseTbl[256];              /* s_reverseTbl[k] = e/k (1<=k<255) */
     };
 
 public:
     static const unsigned int GF28_INVALID = 0x100;
+    typedef GF28Region Region;      /* region (buffer) operations */
 public:
     GF28Value(void) :
             m_value(0) {
@@ -73,9 +135,9 @@ public:
     }
     ~GF28Value() {
     }
-    /* multiplication table singleton (needing c++11) */
-    static inline _MULTIPLICATION_TABLE* getMultiplicationTblIns(void) {
-        static _MULTIPLICATION_TABLE s_multiple_tbl;
+    /* multiplication table (constant initialized, no guard) */
+    static inline const _MULTIPLICATION_TABLE* getMultiplicationTblIns(void) {
+        static constexpr _MULTIPLICATION_TABLE s_multiple_tbl;
         return &s_multiple_tbl;
     }
     inline GF28Value& operator=(const GF28Value &a) {
@@ -94,37 +156,24 @@ public:
     inline GF28Value operator-(const GF28Value &a) const {
         return GF28Value(this->value() ^ a.value());
     }
+    /* i * j = g^(log(i) + log(j)), or i * j = 0 if i or j is 0.
+     * The zero case is masked instead of branched. */
     inline GF28Value operator*(const GF28Value &a) const {
-        unsigned int r;
-        unsigned int i = this->value();
-        unsigned int j = a.value();
-        _MULTIPLICATION_TABLE *ins = getMultiplicationTblIns();
-        if (i == 0 || j == 0) {
-            r = 0;
-        } else {
-            r = ins->getForward(
-                    (ins->getBackward(i) + ins->getBackward(j)) % 255);
-        }
-        return GF28Value(r);
+        return GF28Value(multiply(this->value(), a.value()));
     }
     inline GF28Value operator/(const GF28Value &a) const {
-        unsigned int r;
         unsigned int i = this->value();
         unsigned int j = a.value();
-        _MULTIPLICATION_TABLE *ins = getMultiplicationTblIns();
         if (j == 0) {
-            r = GF28_INVALID;
             std::cout << "Detect a div 0 error!!!" << std::endl;
-        } else if (i == 0) {
-            r = 0;
-        } else {
-            r = ins->getForward(
-                    (ins->getBackward(i) + ins->getBackward(ins->getReverse(j)))
-                            % 255);
+            return GF28Value(GF28_INVALID);
         }
-        return GF28Value(r);
+        /* i / j = g^(log(i) + 255 - log(j)) */
+        unsigned int mask = -(unsigned int) (i != 0);
+        return GF28Value(GF28_EXP_TABLE::s_expTbl[GF28_LOG_TABLE::s_logTbl[i]
+                + 255 - GF28_LOG_TABLE::s_logTbl[j]] & mask);
     }
-    /* power(*this, a) */
+    /* power(*this, a) = g^(log(i) * j) */
     inline GF28Value operator^(const GF28Value &a) const {
         unsigned int i = this->value();
         unsigned int j = a.value();
@@ -132,14 +181,21 @@ public:
             return GF28Value(1);
         } else if (i == 0) {
             return GF28Value(0);
-        } else {
-            GF28Value r(i);
-            GF28Value t(i);
-            for (int k = 0; k < j - 1; ++k) {
-                r = r * t;
-            }
-            return r;
         }
+        return GF28Value(GF28_EXP_TABLE::s_expTbl[(GF28_LOG_TABLE::s_logTbl[i] * j) % 255]);
+    }
+    /* e/i (i != 0) */
+    inline GF28Value inverse(void) const {
+        return GF28Value(GF28_INVERSE_TABLE::s_inverseTbl[this->value()]);
+    }
+    static inline unsigned char multiply(unsigned int i, unsigned int j) {
+#ifdef GF28_PRODUCT_TABLE
+        return GF28_PRODUCT_TABLE_TYPE::s_productTbl[(i << 8) | j];
+#else
+        unsigned int mask = -(unsigned int) ((i != 0) & (j != 0));
+        return GF28_EXP_TABLE::s_expTbl[GF28_LOG_TABLE::s_logTbl[i]
+                + GF28_LOG_TABLE::s_logTbl[j]] & mask;
+#endif
     }
     inline unsigned int value(void) const {
         return m_value;
@@ -0,0 +1,239 @@
+/*
+ * GF2wRegion.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include "GF28Region.hh"
+#include "GF2wRegion.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GF2W_REGION_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/* Scalar kernels */
+template<bool ADD>
+static void nibbleScalar(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char p = tbl[src[i] & 0x0f] ^ tbl[16 + (src[i] >> 4)];
+        dst[i] = ADD ? (dst[i] ^ p) : p;
+    }
+}
+
+template<bool ADD>
+static void wordScalar(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    for (size_t i = 0; i + 2 <= len; i += 2) {
+        unsigned int lo = src[i];
+        unsigned int hi = src[i + 1];
+        unsigned char p0 = tbl[lo & 0x0f] ^ tbl[32 + (lo >> 4)]
+                ^ tbl[64 + (hi & 0x0f)] ^ tbl[96 + (hi >> 4)];
+        unsigned char p1 = tbl[16 + (lo & 0x0f)] ^ tbl[48 + (lo >> 4)]
+                ^ tbl[80 + (hi & 0x0f)] ^ tbl[112 + (hi >> 4)];
+        dst[i] = ADD ? (dst[i] ^ p0) : p0;
+        dst[i + 1] = ADD ? (dst[i + 1] ^ p1) : p1;
+    }
+}
+
+#ifdef GF2W_REGION_X86
+/* SSSE3 kernels */
+template<bool ADD>
+__attribute__((target("ssse3")))
+static void nibbleSsse3(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    const __m128i lo = _mm_loadu_si128((const __m128i *) tbl);
+    const __m128i hi = _mm_loadu_si128((const __m128i *) (tbl + 16));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i p = _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        if (ADD) {
+            p = _mm_xor_si128(p, _mm_loadu_si128((const __m128i *) (dst + i)));
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), p);
+    }
+    nibbleScalar<ADD>(dst + i, src + i, tbl, len - i);
+}
+
+/* 16 words per iteration: low and high bytes are gathered with pshufb and
+ * unpack, and the two result bytes are interleaved again with unpack */
+template<bool ADD>
+__attribute__((target("ssse3")))
+static void wordSsse3(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    __m128i t[8];
+    for (unsigned int q = 0; q < 8; ++q) {
+        t[q] = _mm_loadu_si128((const __m128i *) (tbl + 16 * q));
+    }
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+            1, 3, 5, 7, 9, 11, 13, 15);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (src + i)), split);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (src + i + 16)), split);
+        __m128i lo = _mm_unpacklo_epi64(a, b);
+        __m128i hi = _mm_unpackhi_epi64(a, b);
+        __m128i n0 = _mm_and_si128(lo, mask);
+        __m128i n1 = _mm_and_si128(_mm_srli_epi64(lo, 4), mask);
+        __m128i n2 = _mm_and_si128(hi, mask);
+        __m128i n3 = _mm_and_si128(_mm_srli_epi64(hi, 4), mask);
+        __m128i p0 = _mm_xor_si128(
+                _mm_xor_si128(_mm_shuffle_epi8(t[0], n0), _mm_shuffle_epi8(t[2], n1)),
+                _mm_xor_si128(_mm_shuffle_epi8(t[4], n2), _mm_shuffle_epi8(t[6], n3)));
+        __m128i p1 = _mm_xor_si128(
+                _mm_xor_si128(_mm_shuffle_epi8(t[1], n0), _mm_shuffle_epi8(t[3], n1)),
+                _mm_xor_si128(_mm_shuffle_epi8(t[5], n2), _mm_shuffle_epi8(t[7], n3)));
+        __m128i x = _mm_unpacklo_epi8(p0, p1);
+        __m128i y = _mm_unpackhi_epi8(p0, p1);
+        if (ADD) {
+            x = _mm_xor_si128(x, _mm_loadu_si128((const __m128i *) (dst + i)));
+            y = _mm_xor_si128(y, _mm_loadu_si128((const __m128i *) (dst + i + 16)));
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), x);
+        _mm_storeu_si128((__m128i *) (dst + i + 16), y);
+    }
+    wordScalar<ADD>(dst + i, src + i, tbl, len - i);
+}
+
+/* AVX2 kernels, the tables are broadcast to both lanes */
+template<bool ADD>
+__attribute__((target("avx2")))
+static void nibbleAvx2(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    const __m256i lo = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *) tbl));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *) (tbl + 16)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i p = _mm256_xor_si256(
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        if (ADD) {
+            p = _mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *) (dst + i)));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    nibbleScalar<ADD>(dst + i, src + i, tbl, len - i);
+}
+
+/* 32 words per iteration, shuffles and unpacks stay inside the 128 bit
+ * lanes, so words 0..15 come out of the low unpack and 16..31 of the high */
+template<bool ADD>
+__attribute__((target("avx2")))
+static void wordAvx2(unsigned char *dst, const unsigned char *src,
+        const unsigned char *tbl, size_t len) {
+    __m256i t[8];
+    for (unsigned int q = 0; q < 8; ++q) {
+        t[q] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i *) (tbl + 16 * q)));
+    }
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    const __m256i split = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+            0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15));
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i a = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *) (src + i)), split);
+        __m256i b = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *) (src + i + 32)), split);
+        __m256i lo = _mm256_unpacklo_epi64(a, b);
+        __m256i hi = _mm256_unpackhi_epi64(a, b);
+        __m256i n0 = _mm256_and_si256(lo, mask);
+        __m256i n1 = _mm256_and_si256(_mm256_srli_epi64(lo, 4), mask);
+        __m256i n2 = _mm256_and_si256(hi, mask);
+        __m256i n3 = _mm256_and_si256(_mm256_srli_epi64(hi, 4), mask);
+        __m256i p0 = _mm256_xor_si256(
+                _mm256_xor_si256(_mm256_shuffle_epi8(t[0], n0), _mm256_shuffle_epi8(t[2], n1)),
+                _mm256_xor_si256(_mm256_shuffle_epi8(t[4], n2), _mm256_shuffle_epi8(t[6], n3)));
+        __m256i p1 = _mm256_xor_si256(
+                _mm256_xor_si256(_mm256_shuffle_epi8(t[1], n0), _mm256_shuffle_epi8(t[3], n1)),
+                _mm256_xor_si256(_mm256_shuffle_epi8(t[5], n2), _mm256_shuffle_epi8(t[7], n3)));
+        __m256i x = _mm256_unpacklo_epi8(p0, p1);
+        __m256i y = _mm256_unpackhi_epi8(p0, p1);
+        if (ADD) {
+            x = _mm256_xor_si256(x, _mm256_loadu_si256((const __m256i *) (dst + i)));
+            y = _mm256_xor_si256(y, _mm256_loadu_si256((const __m256i *) (dst + i + 32)));
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), x);
+        _mm256_storeu_si256((__m256i *) (dst + i + 32), y);
+    }
+    wordScalar<ADD>(dst + i, src + i, tbl, len - i);
+}
+#endif /* GF2W_REGION_X86 */
+
+static const GF2wKernel::REGION_FUNC s_nibbleFunc[][2] = {
+        { nibbleScalar<false>, nibbleScalar<true> },
+#ifdef GF2W_REGION_X86
+        { nibbleSsse3<false>, nibbleSsse3<true> },
+        { nibbleAvx2<false>, nibbleAvx2<true> },
+#else
+        { NULL, NULL }, { NULL, NULL },
+#endif
+};
+static const GF2wKernel::REGION_FUNC s_wordFunc[][2] = {
+        { wordScalar<false>, wordScalar<true> },
+#ifdef GF2W_REGION_X86
+        { wordSsse3<false>, wordSsse3<true> },
+        { wordAvx2<false>, wordAvx2<true> },
+#else
+        { NULL, NULL }, { NULL, NULL },
+#endif
+};
+
+GF2wKernel::_KERNEL_TABLE::_KERNEL_TABLE() {
+    /* same CPU features as the GF(2^8) kernels */
+    m_supported[e_gf2w_kernel_scalar] = true;
+    m_supported[e_gf2w_kernel_ssse3] = GF28Region::isSupported(
+            GF28Region::e_gf28_kernel_ssse3);
+    m_supported[e_gf2w_kernel_avx2] = GF28Region::isSupported(
+            GF28Region::e_gf28_kernel_avx2);
+    /* the best kernel is the last supported one */
+    m_kernel = e_gf2w_kernel_scalar;
+    for (int i = 0; i < e_gf2w_kernel_max; ++i) {
+        if (m_supported[i]) {
+            m_kernel = (E_GF2W_KERNEL) i;
+        }
+    }
+    for (int add = 0; add < 2; ++add) {
+        m_nibble[add] = s_nibbleFunc[m_kernel][add];
+        m_word[add] = s_wordFunc[m_kernel][add];
+    }
+}
+
+bool GF2wKernel::isSupported(E_GF2W_KERNEL kernel) {
+    if (kernel < 0 || kernel >= e_gf2w_kernel_max) {
+        return false;
+    }
+    return getKernelTblIns()->m_supported[kernel];
+}
+
+bool GF2wKernel::setKernel(E_GF2W_KERNEL kernel) {
+    if (!isSupported(kernel)) {
+        return false;
+    }
+    _KERNEL_TABLE *ins = getKernelTblIns();
+    ins->m_kernel = kernel;
+    for (int add = 0; add < 2; ++add) {
+        ins->m_nibble[add] = s_nibbleFunc[kernel][add];
+        ins->m_word[add] = s_wordFunc[kernel][add];
+    }
+    return true;
+}
+
+const char* GF2wKernel::kernelName(E_GF2W_KERNEL kernel) {
+    static const char *name[] = { "scalar", "ssse3", "avx2" };
+    if (kernel < 0 || kernel >= e_gf2w_kernel_max) {
+        return "unknown";
+    }
+    return name[kernel];
+}
@@ -0,0 +1,160 @@
+/*
+ * GF2wRegion.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef GF2WREGION_HH_
+#define GF2WREGION_HH_
+
+#include <cstddef>
+
+/* Table driven region kernels shared by the GF(2^w) fields.
+ * The caller builds the lookup tables of its coefficient, so the kernels do
+ * not depend on the field polynomial.
+ * nibble: every byte x is replaced by tbl[x & 0x0f] ^ tbl[16 + (x >> 4)],
+ * which is c*x for GF(2^8) and two packed symbols for GF(2^4).
+ * word: every little endian 16 bit word x is split into its 4 nibbles, the
+ * low (high) result byte is the xor of tbl[32 * q + n] (tbl[32 * q + 16 + n])
+ * of nibble q. For GF(2^16), low bytes and high bytes of 16 words are
+ * gathered into two registers, so the 8 tables are 8 pshufb.
+ *  */
+class GF2wKernel {
+public:
+    typedef enum {
+        e_gf2w_kernel_scalar = 0,
+        e_gf2w_kernel_ssse3,
+        e_gf2w_kernel_avx2,
+        e_gf2w_kernel_max,
+    } E_GF2W_KERNEL;
+
+    typedef void (*REGION_FUNC)(unsigned char *dst, const unsigned char *src,
+            const unsigned char *tbl, size_t len);
+
+private:
+    class _KERNEL_TABLE {
+    public:
+        _KERNEL_TABLE();
+    public:
+        E_GF2W_KERNEL m_kernel;                 /* selected kernel */
+        REGION_FUNC m_nibble[2];                /* [add] 32 bytes of tables */
+        REGION_FUNC m_word[2];                  /* [add] 128 bytes of tables */
+        bool m_supported[e_gf2w_kernel_max];    /* kernels the CPU can run */
+    };
+
+public:
+    /* kernel table singleton (needing c++11) */
+    static inline _KERNEL_TABLE* getKernelTblIns(void) {
+        static _KERNEL_TABLE s_kernel_tbl;
+        return &s_kernel_tbl;
+    }
+    /* dst = f(src), or dst ^= f(src) if add */
+    static inline void nibble(unsigned char *dst, const unsigned char *src,
+            const unsigned char *tbl, size_t len, bool add) {
+        getKernelTblIns()->m_nibble[add](dst, src, tbl, len);
+    }
+    /* len must be a multiple of 2 */
+    static inline void word(unsigned char *dst, const unsigned char *src,
+            const unsigned char *tbl, size_t len, bool add) {
+        getKernelTblIns()->m_word[add](dst, src, tbl, len);
+    }
+
+    static E_GF2W_KERNEL kernel(void) {
+        return getKernelTblIns()->m_kernel;
+    }
+    static bool isSupported(E_GF2W_KERNEL kernel);
+    /* Force a kernel (for testing and benchmarking), returns false if the CPU
+     * can not run it. */
+    static bool setKernel(E_GF2W_KERNEL kernel);
+    static const char* kernelName(E_GF2W_KERNEL kernel);
+};
+
+template<unsigned int W, unsigned int POLY> class GF2wValue;
+
+/* Symbol of GF(2^w) as stored in coefficients */
+template<unsigned int W> struct GF2wSymbol {
+    typedef unsigned char type;
+};
+template<> struct GF2wSymbol<16> {
+    typedef unsigned short type;
+};
+
+/* Region operations of GF(2^w), the same interface as GF28Region.
+ * w = 4: every byte holds two symbols, both are multiplied by c.
+ * w = 8: every byte is a symbol.
+ * w = 16: every 2 bytes (little endian) are a symbol, len must be a
+ * multiple of SYMBOL_SIZE.
+ *  */
+template<unsigned int W, unsigned int POLY>
+class GF2wRegion {
+public:
+    static_assert(W == 4 || W == 8 || W == 16, "GF2wRegion supports w = 4, 8 and 16");
+    typedef typename GF2wSymbol<W>::type SYMBOL;
+    static const size_t SYMBOL_SIZE = sizeof(SYMBOL);
+
+public:
+    /* dst[i] = c * src[i] */
+    static inline void multiply(unsigned char *dst, const unsigned char *src,
+            SYMBOL c, size_t len) {
+        region(dst, src, c, len, false);
+    }
+    /* dst[i] ^= c * src[i] */
+    static inline void multiplyAdd(unsigned char *dst,
+            const unsigned char *src, SYMBOL c, size_t len) {
+        if (c != 0) {
+            region(dst, src, c, len, true);
+        }
+    }
+    /* dst[i] = c[0] * src[0][offset + i] + ... + c[n-1] * src[n-1][offset + i]
+     * The tables of a coefficient are built once per call, so the sources are
+     * accumulated one by one while dst stays in cache. */
+    static inline void dotProduct(unsigned char *dst,
+            const unsigned char * const *src, size_t offset,
+            const SYMBOL *c, unsigned int n, size_t len) {
+        unsigned int k = 0;
+        while (k < n && c[k] == 0) {
+            ++k;
+        }
+        if (k == n) {
+            for (size_t i = 0; i < len; ++i) {
+                dst[i] = 0;
+            }
+            return;
+        }
+        multiply(dst, src[k] + offset, c[k], len);
+        for (++k; k < n; ++k) {
+            multiplyAdd(dst, src[k] + offset, c[k], len);
+        }
+    }
+
+private:
+    static void region(unsigned char *dst, const unsigned char *src,
+            SYMBOL c, size_t len, bool add) {
+        typedef GF2wValue<W, POLY> VALUE;
+        if (W == 16) {
+            unsigned char tbl[128] __attribute__((aligned(16)));
+            for (unsigned int q = 0; q < 4; ++q) {
+                for (unsigned int n = 0; n < 16; ++n) {
+                    unsigned int p = (VALUE(c) * VALUE(n << (4 * q))).value();
+                    tbl[32 * q + n] = p & 0xff;
+                    tbl[32 * q + 16 + n] = p >> 8;
+                }
+            }
+            GF2wKernel::word(dst, src, tbl, len, add);
+        } else {
+            unsigned char tbl[32] __attribute__((aligned(16)));
+            for (unsigned int n = 0; n < 16; ++n) {
+                if (W == 8) {
+                    tbl[n] = (VALUE(c) * VALUE(n)).value();
+                    tbl[16 + n] = (VALUE(c) * VALUE(n << 4)).value();
+                } else {
+                    tbl[n] = (VALUE(c) * VALUE(n)).value();
+                    tbl[16 + n] = tbl[n] << 4;
+                }
+            }
+            GF2wKernel::nibble(dst, src, tbl, len, add);
+        }
+    }
+};
+
+#endif /* GF2WREGION_HH_ */
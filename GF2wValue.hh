@@ -0,0 +1,153 @@
+/*
+ * GF2wValue.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef GF2WVALUE_HH_
+#define GF2WVALUE_HH_
+
+#include <iostream>
+
+#include "GF2wRegion.hh"
+
+/* Element of GF(2^w) with the primitive polynomial POLY (bit w set), the
+ * same interfaces as GF28Value, so RScode<GF2wValue<W, POLY> > works for
+ * any w. With w = 16 a code has up to 65536 lines.
+ * The log/exp tables (2^w entries each) are a static member built when the
+ * program is loaded, so the operators read them with no initialization
+ * guard. GF28Value generates its tables at compile time, which the
+ * constexpr recursion limits of c++11 do not allow for the logarithms of
+ * 2^16 elements; as with any object with dynamic initialization, the
+ * operators must not be used by static initializers of other translation
+ * units.
+ *  */
+template<unsigned int W, unsigned int POLY>
+class GF2wValue {
+public:
+    static_assert(W >= 2 && W <= 16, "GF2wValue supports 2 <= w <= 16");
+    static_assert((POLY >> W) == 1, "POLY must be of degree w");
+    static const unsigned int ORDER = (1u << W) - 1;    /* order of the generator */
+    typedef GF2wRegion<W, POLY> Region;                 /* region (buffer) operations */
+
+private:
+    class _MULTIPLICATION_TABLE {
+    public:
+        _MULTIPLICATION_TABLE() {
+            unsigned int v = 1;                                 /* g^0 = e */
+            for (unsigned int k = 0; k < ORDER; ++k) {
+                m_expTbl[k] = v;
+                m_expTbl[k + ORDER] = v;
+                m_logTbl[v] = k;
+                v <<= 1;                                        /* g(generator): x */
+                if (v & (1u << W)) {
+                    v ^= POLY;
+                }
+            }
+            m_logTbl[0] = 0;                                    /* unused */
+        }
+    public:
+        unsigned short m_expTbl[2 * ORDER];     /* m_expTbl[k] = g^(k % ORDER) */
+        unsigned short m_logTbl[ORDER + 1];     /* m_logTbl[g^k] = k */
+    };
+
+public:
+    GF2wValue(void) :
+            m_value(0) {
+    }
+    GF2wValue(unsigned int value) :
+            m_value(value & ORDER) {
+    }
+    ~GF2wValue() {
+    }
+    /* multiplication table */
+    static inline const _MULTIPLICATION_TABLE* getMultiplicationTblIns(void) {
+        return &s_multiple_tbl;
+    }
+    inline GF2wValue& operator=(const GF2wValue &a) {
+        this->m_value = a.value();
+        return *this;
+    }
+    inline bool operator==(const GF2wValue &a) const {
+        return (this->m_value == a.value());
+    }
+    inline bool operator!=(const GF2wValue &a) const {
+        return !(this->m_value == a.value());
+    }
+    inline GF2wValue operator+(const GF2wValue &a) const {
+        return GF2wValue(this->value() ^ a.value());
+    }
+    inline GF2wValue operator-(const GF2wValue &a) const {
+        return GF2wValue(this->value() ^ a.value());
+    }
+    /* i * j = g^(log(i) + log(j)) */
+    inline GF2wValue operator*(const GF2wValue &a) const {
+        unsigned int i = this->value();
+        unsigned int j = a.value();
+        if (i == 0 || j == 0) {
+            return GF2wValue(0);
+        }
+        const _MULTIPLICATION_TABLE *ins = getMultiplicationTblIns();
+        return GF2wValue(ins->m_expTbl[ins->m_logTbl[i] + ins->m_logTbl[j]]);
+    }
+    /* i / j = g^(log(i) + ORDER - log(j)) */
+    inline GF2wValue operator/(const GF2wValue &a) const {
+        unsigned int i = this->value();
+        unsigned int j = a.value();
+        if (j == 0) {
+            std::cout << "Detect a div 0 error!!!" << std::endl;
+            return GF2wValue(0);
+        } else if (i == 0) {
+            return GF2wValue(0);
+        }
+        const _MULTIPLICATION_TABLE *ins = getMultiplicationTblIns();
+        return GF2wValue(ins->m_expTbl[ins->m_logTbl[i] + ORDER - ins->m_logTbl[j]]);
+    }
+    /* power(*this, a) = g^(log(i) * j) */
+    inline GF2wValue operator^(const GF2wValue &a) const {
+        unsigned int i = this->value();
+        unsigned int j = a.value();
+        if (j == 0) {
+            return GF2wValue(1);
+        } else if (i == 0) {
+            return GF2wValue(0);
+        }
+        const _MULTIPLICATION_TABLE *ins = getMultiplicationTblIns();
+        return GF2wValue(ins->m_expTbl[(unsigned long long) ins->m_logTbl[i] * j % ORDER]);
+    }
+    /* e/i (i != 0) */
+    inline GF2wValue inverse(void) const {
+        return GF2wValue(1) / *this;
+    }
+    inline unsigned int value(void) const {
+        return m_value;
+    }
+    inline void output(std::ostream &s) const {
+        std::streamsize w = s.width();
+        s.width((W + 3) / 4);
+        char f = s.fill();
+        s.fill('0');
+        s.setf(std::ios::hex, std::ios::basefield);
+        s << m_value << " ";
+        s.unsetf(std::ios::hex);
+        s.fill(f);
+        s.width(w);
+    }
+    inline static unsigned int limit(void) {
+        return 1u << W;
+    }
+protected:
+    unsigned int m_value;
+
+private:
+    static const _MULTIPLICATION_TABLE s_multiple_tbl;
+};
+
+template<unsigned int W, unsigned int POLY>
+const typename GF2wValue<W, POLY>::_MULTIPLICATION_TABLE GF2wValue<W, POLY>::s_multiple_tbl;
+
+typedef GF2wValue<4, 0x13> GF24Value;           /* x^4 + x + 1 */
+typedef GF2wValue<8, 0x11D> GF2w8Value;         /* x^8 + x^4 + x^3 + x^2 + 1, same field as GF28Value */
+typedef GF2wValue<16, 0x1100B> GF216Value;      /* x^16 + x^12 + x^3 + x + 1 */
+
+#endif /* GF2WVALUE_HH_ */
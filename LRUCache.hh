@@ -0,0 +1,112 @@
+/*
+ * LRUCache.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef LRUCACHE_HH_
+#define LRUCACHE_HH_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <utility>
+
+/* Bounded least recently used cache.
+ * Values are immutable and shared, a value returned by get() stays valid
+ * even if it is evicted meanwhile, so many threads can use the cache at
+ * the same time. Every call takes the lock, callers on a hot path keep
+ * the values they use instead of looking them up each time.
+ * K must be less-than comparable.
+ *  */
+template<typename K, typename V>
+class LRUCache {
+public:
+    typedef std::shared_ptr<const V> VALUE_PTR;
+
+public:
+    LRUCache(size_t capacity) :
+            m_capacity(capacity), m_hits(0), m_misses(0) {
+    }
+    ~LRUCache() {
+    }
+    LRUCache(const LRUCache &) = delete;
+    LRUCache& operator=(const LRUCache &) = delete;
+
+    /* Returns NULL if key is not cached */
+    VALUE_PTR get(const K &key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        typename INDEX::iterator it = m_index.find(key);
+        if (it == m_index.end()) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return VALUE_PTR();
+        }
+        if (it->second != m_list.begin()) {
+            m_list.splice(m_list.begin(), m_list, it->second);  /* most recently used */
+        }
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->second;
+    }
+    void put(const K &key, const VALUE_PTR &value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_capacity == 0) {
+            return;
+        }
+        typename INDEX::iterator it = m_index.find(key);
+        if (it != m_index.end()) {
+            it->second->second = value;
+            m_list.splice(m_list.begin(), m_list, it->second);
+            return;
+        }
+        m_list.push_front(std::make_pair(key, value));
+        m_index[key] = m_list.begin();
+        evict();
+    }
+    void clear(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_index.clear();
+        m_list.clear();
+    }
+    void setCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capacity = capacity;
+        evict();
+    }
+    size_t capacity(void) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_capacity;
+    }
+    size_t size(void) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_list.size();
+    }
+    unsigned long long hits(void) const {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+    unsigned long long misses(void) const {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    /* Drop least recently used entries, m_mutex must be held */
+    void evict(void) {
+        while (m_list.size() > m_capacity) {
+            m_index.erase(m_list.back().first);
+            m_list.pop_back();
+        }
+    }
+
+private:
+    typedef std::list<std::pair<K, VALUE_PTR> > LIST;
+    typedef std::map<K, typename LIST::iterator> INDEX;
+    size_t m_capacity;                          /* Max number of entries */
+    LIST m_list;                                /* Most recently used first */
+    INDEX m_index;                              /* Key to list position */
+    mutable std::mutex m_mutex;
+    std::atomic<unsigned long long> m_hits;
+    std::atomic<unsigned long long> m_misses;
+};
+
+#endif /* LRUCACHE_HH_ */
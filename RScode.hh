@@ -11,6 +11,20 @@
 #include <iostream>
 #include <type_traits>
 #include <limits>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <unistd.h>
+
+#include "LRUCache.hh"
+#include "Arena.hh"
+#include "RSstats.hh"
+#include "Crc32c.hh"
 
 using namespace std;
 
@@ -25,10 +39,28 @@ using namespace std;
  * T operator*(const T &) const
  * T operator/(const T &) const
  * void output(std::ostream &)
- * unsigned char value(void)
+ * unsigned int value(void)
  * static unsigned int limit(void);
+ * and for the byte oriented methods (encodeStripe) a region type
+ * T::Region with a coefficient type SYMBOL of SYMBOL_SIZE bytes and static methods
+ * void multiplyAdd(unsigned char *dst, const unsigned char *src, SYMBOL c, size_t len)
+ * void dotProduct(unsigned char *dst, const unsigned char * const *src, size_t offset,
+ *         const SYMBOL *c, unsigned int n, size_t len)
+ * Lengths of shards must be multiples of SYMBOL_SIZE.
  *  */
 
+/* Coefficient type of T, bytes for floating point types */
+template<typename T, typename IS_FLOATING>
+struct symbol_type_traits {
+    typedef typename T::Region::SYMBOL type;
+    static const size_t SIZE = T::Region::SYMBOL_SIZE;
+};
+template<typename T>
+struct symbol_type_traits<T, true_type> {
+    typedef unsigned char type;
+    static const size_t SIZE = 1;
+};
+
 /* TODO: floating point matrix based encoding/decoding
  * */
 template<typename T>
@@ -40,120 +72,399 @@ public:
         e_rscode_sts_construct_err,
         e_rscode_sts_encoding_err,
         e_rscode_sts_decoding_err,
+        e_rscode_sts_size_err,              /* Line size, shard size or column range */
+        e_rscode_sts_index_err,             /* Row out of the encoding matrix */
+        e_rscode_sts_limit_err,             /* Too many lines */
+        e_rscode_sts_shards_err,            /* Not enough shards to decode */
+        e_rscode_sts_singular_err,          /* Encoded rows are not independent */
+        e_rscode_sts_output_err,            /* No output for a missing line */
+        e_rscode_sts_corrupt_err,           /* A corrupt shard was found */
+        e_rscode_sts_uncorrectable_err,     /* Inconsistent, not one corrupt shard */
+        e_rscode_sts_io_err,                /* Shard file can not be read or written */
     } E_RSCODE_STS;
 private:
-    struct value_type_traits: public is_floating_point<T> { };
     typedef typename is_floating_point<T>::type T_IS_FLOATING;
+public:
+    typedef typename symbol_type_traits<T, T_IS_FLOATING>::type SYMBOL;
+    static const size_t SYMBOL_SIZE = symbol_type_traits<T, T_IS_FLOATING>::SIZE;
+    /* Encoded shard of scatter/gather decoding */
+    struct Shard {
+        unsigned int index;                 /* Row of the encoding matrix */
+        const unsigned char *data;          /* Shard contents */
+    };
+    /* Decoding rows of one survivor pattern (immutable once created) */
+    struct DecodePlan {
+        std::vector<unsigned int> m_missing;    /* Missing data lines */
+        std::vector<SYMBOL> m_matrix;           /* Their rows of the decoding matrix */
+    };
+    typedef std::shared_ptr<const DecodePlan> DECODE_PLAN;
+    /* Per-thread state of a shared codec.
+     * The codec is read-only once constructed, so any number of threads can
+     * share one codec through the const methods, each thread with its own
+     * Context for the scratch space of decoding, the encodeLine cursor, the
+     * status of the last call and the decoding rows of the last pattern.
+     * Decoding looks the pattern up in the Context first, so a thread which
+     * decodes the same pattern again takes no lock and writes nothing the
+     * other threads read; only a change of pattern goes to the codec's
+     * shared (locked) cache.
+     * A Context is sized for the codec at the first use and reused
+     * afterwards, so decoding makes no heap allocations once the decoding
+     * rows are cached.
+     *  */
+    struct Context {
+        std::vector<unsigned int> m_index;          /* Selected encoded rows */
+        std::vector<unsigned int> m_pick;           /* Selected shards */
+        std::vector<SYMBOL> m_check;                /* Check row of verify */
+        std::vector<std::uint32_t> m_crc;           /* Checksums of source and destination rows */
+        std::vector<const unsigned char*> m_src;    /* Source rows */
+        std::vector<unsigned char*> m_dst;          /* Destination rows */
+        unsigned int m_curLine = 0;                 /* Cursor of encodeLine */
+        E_RSCODE_STS m_error = e_rscode_sts_ok;     /* Status of the last call */
+        /* Decoding rows got last, for the pattern m_planIndex of the codec
+         * m_planCode */
+        std::vector<unsigned int> m_planIndex;
+        DECODE_PLAN m_plan;
+        unsigned long long m_planCode = 0;
+
+        inline E_RSCODE_STS error(void) const {return m_error;};
+        void clear(void) {
+            m_curLine = 0;
+            m_error = e_rscode_sts_ok;
+        }
+    };
+private:
+    struct value_type_traits: public is_floating_point<T> { };
+    typedef LRUCache<std::vector<unsigned int>, DecodePlan> DECODE_CACHE;
+    /* FEC rows of the encoding matrix as region coefficients */
+    struct CauchyRows {
+        unsigned int m_count;               /* Rows */
+        SYMBOL *m_bytes;                    /* m_count x encodeLineSize */
+        Arena m_arena;
+    };
 
 public:
-    RScode(unsigned int encodeLineSize, unsigned int dataLineSize) {
-        if (encodeLineSize < 1 || encodeLineSize > limit(T(), T_IS_FLOATING())) {
-            m_error = e_rscode_sts_construct_err;
+    /* limit is the number of encoding matrix rows (data and FEC lines),
+     * 0 means every line of the field (limit of T).
+     * Only the FEC rows are stored, as region coefficients. With a limit,
+     * its limit - encodeLineSize FEC rows are created here; without one,
+     * none are, and FEC rows are created when first used (in generations
+     * of doubling size which are never moved, so callers keep no lock).
+     * The rows of a generation are carved from one 64-byte aligned arena,
+     * mapped from huge pages if hugePages. Decoding scratch space is only
+     * allocated by the first decoding.
+     *  */
+    RScode(unsigned int encodeLineSize, unsigned int dataLineSize,
+            unsigned int limit = 0, bool hugePages = false) {
+        const bool configured = limit != 0;
+        if (limit == 0) {
+            limit = this->limit(T(), T_IS_FLOATING());
+        }
+        if (encodeLineSize < 1 || limit > this->limit(T(), T_IS_FLOATING())
+                || encodeLineSize > limit) {
+            m_state = m_error = e_rscode_sts_construct_err;
         } else {
-            dbg_w = cout.width();
-            dbg_c = cout.fill();
-            dbg_f = cout.flags();
             m_encodeLineSize = encodeLineSize;
-            m_limit = limit(T(), T_IS_FLOATING());
-            m_curLine = 0;
-            m_pCauchyMatrix = new T[encodeLineSize * m_limit];
-            m_pL = new T[m_encodeLineSize * m_encodeLineSize];
-            m_pU = new T[m_encodeLineSize * m_encodeLineSize];
-            m_pLInverseMatrix = new T[m_encodeLineSize * m_encodeLineSize];
-            m_pUInverseMatrix = new T[m_encodeLineSize * m_encodeLineSize];
-            m_pEncodeMatrix = new T[m_encodeLineSize * m_encodeLineSize];
-            m_pEncodeInverseMatrix = new T[m_encodeLineSize * m_encodeLineSize];
-            const T tmp0(0);
-            const T tmp1(1);
-            /* create cauchy matrix */
-            for (int i = 0; i < encodeLineSize; ++i) {
-                for (int j = 0; j < encodeLineSize; ++j) {
-                    if (i == j) {
-                        *position(m_pCauchyMatrix, i, j) = tmp1;
-                    } else {
-                        *position(m_pCauchyMatrix, i, j) = tmp0;
-                    }
-                }
+            m_limit = limit;
+            m_hugePages = hugePages;
+            m_pDecodeCache = new DECODE_CACHE(DECODE_CACHE_SIZE);
+            m_id = newId();
+            m_pRows.store(grow(configured ? limit - encodeLineSize : 0));
+            if (m_pRows.load()->m_bytes == NULL && configured
+                    && limit > encodeLineSize) {
+                m_state = m_error = e_rscode_sts_construct_err;
+                return;
             }
-            for (int i = encodeLineSize; i < m_limit; ++i) {
-                for (int j = 0; j < encodeLineSize; ++j) {
-                    T x(i); /* x = {(encodeLineSize),...,(m_limit-1)} */
-                    T y(j); /* y = {0,...,(encodeLineSize-1)} */
-                    *position(m_pCauchyMatrix, i, j) = T(1) / (x + y); /* 1/(x+y) */
-                }
-            }
-            m_error = e_rscode_sts_ok;
+            m_state = m_error = e_rscode_sts_ok;
         }
     }
     ~RScode() {
-        if (m_error != e_rscode_sts_init
-                && m_error != e_rscode_sts_construct_err) {
-            if (m_pCauchyMatrix)
-                delete[] m_pCauchyMatrix;
-            if (m_pL)
-                delete[] m_pL;
-            if (m_pU)
-                delete[] m_pU;
-            if (m_pLInverseMatrix)
-                delete[] m_pLInverseMatrix;
-            if (m_pUInverseMatrix)
-                delete[] m_pUInverseMatrix;
-            if (m_pEncodeMatrix)
-                delete[] m_pEncodeMatrix;
-            if (m_pEncodeInverseMatrix)
-                delete[] m_pEncodeInverseMatrix;
+        destroy();
+    }
+    RScode(const RScode &) = delete;
+    RScode& operator=(const RScode &) = delete;
+    /* The moved-from codec is left uninitialized */
+    RScode(RScode &&a) {
+        *this = std::move(a);
+    }
+    RScode& operator=(RScode &&a) {
+        if (this != &a) {
+            destroy();
+            m_encodeLineSize = a.m_encodeLineSize;
+            m_limit = a.m_limit;
+            m_hugePages = a.m_hugePages;
+            m_rows = std::move(a.m_rows);
+            m_pRows.store(a.m_pRows.load());
+            m_context = std::move(a.m_context);
+            m_pDecodeCache = a.m_pDecodeCache;
+            m_id = a.m_id;
+            m_tileSize = a.m_tileSize;
+            m_state = a.m_state;
+            m_error = a.m_error;
+            a.m_pRows.store(NULL);
+            a.m_pDecodeCache = NULL;
+            a.m_id = 0;
+            a.m_state = a.m_error = e_rscode_sts_init;
         }
+        return *this;
     }
     void clear() {
-        m_curLine = 0;
-        if (m_error == e_rscode_sts_encoding_err
-                || m_error == e_rscode_sts_decoding_err) {
+        m_context.clear();
+        if (m_state == e_rscode_sts_ok) {
             m_error = e_rscode_sts_ok;
         }
     }
+    /* Message of a status */
+    static const char* errorString(E_RSCODE_STS sts) {
+        switch (sts) {
+        case e_rscode_sts_ok:
+            return "OK.";
+        case e_rscode_sts_init:
+            return "Not initialized.";
+        case e_rscode_sts_construct_err:
+            return "Encoding line size error. Check the encodeLineSize parameter of constructor.";
+        case e_rscode_sts_encoding_err:
+            return "Encoding error.";
+        case e_rscode_sts_decoding_err:
+            return "Decoding error.";
+        case e_rscode_sts_size_err:
+            return "Size error. It should greater then 0 and a multiple of the symbol size.";
+        case e_rscode_sts_index_err:
+            return "Index error.";
+        case e_rscode_sts_limit_err:
+            return "Limit error. Too many lines.";
+        case e_rscode_sts_shards_err:
+            return "Not enough shards to decode.";
+        case e_rscode_sts_singular_err:
+            return "Encoded rows are not independent.";
+        case e_rscode_sts_output_err:
+            return "No output for a missing line.";
+        case e_rscode_sts_corrupt_err:
+            return "Corrupt shard found.";
+        case e_rscode_sts_uncorrectable_err:
+            return "Corrupt stripe, the corrupt shard can not be located.";
+        case e_rscode_sts_io_err:
+            return "Shard file I/O error.";
+        }
+        return "Unknown error.";
+    }
+
+    /* The methods taking a Context are const and return their status (also
+     * kept in the Context), they print nothing and can be called
+     * concurrently. The ones without a Context use the codec's own and
+     * return 0 or -1, printing the error and keeping it for error(), for one
+     * thread using the codec alone.
+     *  */
+
+    /* Encode the next line (row ctx.m_curLine of the encoding matrix).
+     * data is encodeLineSize rows of dataLineSize bytes.
+     * Prefer encodeStripe, which creates all FEC lines in one pass.
+     *  */
     int encodeLine(const unsigned char *data, unsigned int dataLineSize,
             unsigned char *encode) {
-        int ret;
-        if (m_error == e_rscode_sts_init
-                || m_error == e_rscode_sts_construct_err) {
-            cout
-                    << "Encoding line size error. Check the encodeLineSize parameter of constructor."
-                    << endl;
-            return -1;
-        }
-        if (dataLineSize == 0) {
-            m_error = e_rscode_sts_encoding_err;
-            cout << "dataLineSize line size error. It should greater then 0."
-                    << endl;
-            return -1;
-        }
-        if (m_curLine >= m_limit) {
-            m_error = e_rscode_sts_encoding_err;
-            cout << "Limit(" << m_curLine
-                    << ") error. No more date can be encoded." << endl;
-            return -1;
-        }
-        T *tData = new T[dataLineSize * m_encodeLineSize];
-        T *tEncode = new T[dataLineSize];
-        for (unsigned int i = 0; i < dataLineSize * m_encodeLineSize; ++i) {
-            tData[i] = T((unsigned int) data[i]);
-        }
-        ret = matrixMultiplication(position(m_pCauchyMatrix, m_curLine, 0), 1,
-                m_encodeLineSize, tData, m_encodeLineSize, dataLineSize,
-                tEncode);
-        if (ret == 0) {
-            for (unsigned int i = 0; i < dataLineSize; ++i) {
-                encode[i] = value(tEncode[i], T_IS_FLOATING());
-            }
-            m_curLine++;
-        }
-        delete[] tData;
-        delete[] tEncode;
-        return ret;
+        return report(encodeLine(data, dataLineSize, encode, m_context));
+    }
+    E_RSCODE_STS encodeLine(const unsigned char *data,
+            unsigned int dataLineSize, unsigned char *encode,
+            Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (dataLineSize == 0 || dataLineSize % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        if (ctx.m_curLine >= m_limit) {
+            return status(ctx, e_rscode_sts_limit_err);
+        }
+        if (ctx.m_curLine < m_encodeLineSize) {
+            /* identity row */
+            memcpy(encode, data + ctx.m_curLine * dataLineSize, dataLineSize);
+        } else {
+            const unsigned int j = ctx.m_curLine - m_encodeLineSize;
+            const SYMBOL *row = parityRow(j);
+            memset(encode, 0, dataLineSize);
+            for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+                T::Region::multiplyAdd(encode, data + i * dataLineSize, row[i],
+                        dataLineSize);
+            }
+        }
+        ctx.m_curLine++;
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* Encode a whole stripe in one pass.
+     * data[0..encodeLineSize-1] are the data shards, and
+     * parity[0..parityCount-1] receive the FEC shards, which are the rows
+     * encodeLineSize..encodeLineSize+parityCount-1 of the encoding matrix
+     * (the data shards themselves are the identity rows).
+     * Every shard is shardSize bytes.
+     * The stripe is processed in column blocks small enough to stay in
+     * cache, so each data byte is read from memory once for all parities.
+     * This method does not use the encodeLine cursor.
+     *  */
+    E_RSCODE_STS encodeStripe(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize) const {
+        E_RSCODE_STS sts = checkEncode(parityCount, 0, shardSize);
+        if (sts != e_rscode_sts_ok) {
+            return sts;
+        }
+        RSstats::Scope scope(RSstats::e_rs_trace_encode, m_encodeLineSize * shardSize);
+        applyMatrix(parityRows(parityCount), parityCount, data, parity, 0, shardSize);
+        return e_rscode_sts_ok;
+    }
+    /* Encode the columns [offset, offset + length) of a stripe only,
+     * data and parity point to the beginning of the shards.
+     * Different column ranges of a stripe can be encoded concurrently.
+     * A range is part of a pass and is not counted by RSstats, the caller
+     * of the ranges counts the stripe (as RSengine does).
+     *  */
+    E_RSCODE_STS encodeStripe(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t offset, size_t length) const {
+        E_RSCODE_STS sts = checkEncode(parityCount, offset, length);
+        if (sts != e_rscode_sts_ok) {
+            return sts;
+        }
+        applyMatrix(parityRows(parityCount), parityCount, data, parity, offset, length);
+        return e_rscode_sts_ok;
+    }
+    /* Batched encoding of stripes of the same shape: data[s] and parity[s]
+     * are the shards of stripe s (as in encodeStripe). The arguments are
+     * checked and the FEC rows are got once for the whole batch, then the
+     * stripes are encoded in one pass.
+     *  */
+    E_RSCODE_STS encodeStripes(const unsigned char * const * const *data,
+            unsigned char * const * const *parity, unsigned int stripeCount,
+            unsigned int parityCount, size_t shardSize) const {
+        E_RSCODE_STS sts = checkEncode(parityCount, 0, shardSize);
+        if (sts != e_rscode_sts_ok) {
+            return sts;
+        }
+        RSstats::Scope scope(RSstats::e_rs_trace_encode,
+                stripeCount * m_encodeLineSize * shardSize);
+        const SYMBOL *rows = parityRows(parityCount);
+        for (unsigned int s = 0; s < stripeCount; ++s) {
+            applyMatrix(rows, parityCount, data[s], parity[s], 0, shardSize);
+        }
+        return e_rscode_sts_ok;
+    }
+    /* Encode a whole stripe and checksum it in the same pass:
+     * crc[0..encodeLineSize-1] receive the CRC-32C of the data shards and
+     * crc[encodeLineSize..encodeLineSize+parityCount-1] those of the FEC
+     * shards. Every tile is checksummed right after it was encoded, while
+     * it is still in cache, so the stripe is not read from memory again.
+     *  */
+    E_RSCODE_STS encodeStripeCrc(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, std::uint32_t *crc) const {
+        if (m_state != e_rscode_sts_ok) {
+            return m_state;
+        }
+        if (parityCount > m_limit - m_encodeLineSize) {
+            return e_rscode_sts_limit_err;
+        }
+        if (shardSize % SYMBOL_SIZE != 0) {
+            return e_rscode_sts_size_err;
+        }
+        RSstats::Scope scope(RSstats::e_rs_trace_encode, m_encodeLineSize * shardSize);
+        std::fill(crc, crc + m_encodeLineSize + parityCount, 0);
+        applyMatrix(parityRows(parityCount), parityCount, data, parity, 0, shardSize, crc,
+                crc + m_encodeLineSize);
+        return e_rscode_sts_ok;
+    }
+    /* Update FEC shards in place after the columns [offset, offset + length)
+     * of data line dataIndex changed, delta is (old data) ^ (new data) of
+     * those columns:
+     * parity[j][offset + i] ^= C[encodeLineSize + j][dataIndex] x delta[i]
+     * parity[0..parityCount-1] point to the beginning of the FEC shards as in
+     * encodeStripe. Only the changed columns of the data line are read.
+     *  */
+    E_RSCODE_STS updateParity(unsigned int dataIndex, const unsigned char *delta,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t offset, size_t length) const {
+        E_RSCODE_STS sts = checkUpdate(dataIndex, parityCount, offset, length);
+        if (sts != e_rscode_sts_ok) {
+            return sts;
+        }
+        const SYMBOL *column = parityRows(parityCount) + dataIndex;
+        for (size_t done = 0; done < length; done += COLUMN_BLOCK_SIZE) {
+            size_t len = length - done;
+            if (len > COLUMN_BLOCK_SIZE) {
+                len = COLUMN_BLOCK_SIZE;
+            }
+            for (unsigned int j = 0; j < parityCount; ++j) {
+                T::Region::multiplyAdd(parity[j] + offset + done, delta + done,
+                        column[j * m_encodeLineSize], len);
+            }
+        }
+        return e_rscode_sts_ok;
+    }
+    /* Same as above with the old and new contents of the columns
+     * (oldData and newData point to column offset) */
+    E_RSCODE_STS updateParity(unsigned int dataIndex, const unsigned char *oldData,
+            const unsigned char *newData, unsigned char * const *parity,
+            unsigned int parityCount, size_t offset, size_t length) const {
+        E_RSCODE_STS sts = checkUpdate(dataIndex, parityCount, offset, length);
+        if (sts != e_rscode_sts_ok) {
+            return sts;
+        }
+        const SYMBOL *column = parityRows(parityCount) + dataIndex;
+        unsigned char delta[COLUMN_BLOCK_SIZE];
+        for (size_t done = 0; done < length; done += COLUMN_BLOCK_SIZE) {
+            size_t len = length - done;
+            if (len > COLUMN_BLOCK_SIZE) {
+                len = COLUMN_BLOCK_SIZE;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                delta[i] = oldData[done + i] ^ newData[done + i];
+            }
+            for (unsigned int j = 0; j < parityCount; ++j) {
+                T::Region::multiplyAdd(parity[j] + offset + done, delta,
+                        column[j * m_encodeLineSize], len);
+            }
+        }
+        return e_rscode_sts_ok;
+    }
+    /* Scrubbing: check that the FEC shards of a stripe match its data
+     * shards (arguments as in encodeStripe), without re-encoding.
+     * The syndromes S[j] = parity[j] - C[encodeLineSize + j] x data are
+     * zero for a consistent stripe. They are checked in one streaming pass
+     * as a single combination sum(r^j x S[j]), whose data coefficients are
+     * all non-zero, so any one corrupt shard shows up in it (multiple ones
+     * almost surely do), at the cost of one dot product over the shards.
+     * If it is not zero, the corrupt shard is located from the syndromes of
+     * the first inconsistent block and checked against the whole stripe,
+     * which needs parityCount >= 2.
+     * Returns ok, corrupt_err with *corrupt = the row of the corrupt shard,
+     * or uncorrectable_err. corrupt may be NULL.
+     *  */
+    int verify(const unsigned char * const *data,
+            const unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, unsigned int *corrupt) {
+        return report(verify(data, parity, parityCount, shardSize, corrupt,
+                m_context));
+    }
+    E_RSCODE_STS verify(const unsigned char * const *data,
+            const unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, unsigned int *corrupt, Context &ctx) const {
+        return status(ctx, scrub(data, parity, parityCount, shardSize, corrupt,
+                false, ctx));
+    }
+    /* Same as verify, but a located corrupt shard is repaired in place and
+     * ok is returned with *corrupt set to its row (m_limit if none was) */
+    int repair(unsigned char * const *data, unsigned char * const *parity,
+            unsigned int parityCount, size_t shardSize, unsigned int *corrupt) {
+        return report(repair(data, parity, parityCount, shardSize, corrupt,
+                m_context));
+    }
+    E_RSCODE_STS repair(unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, unsigned int *corrupt, Context &ctx) const {
+        return status(ctx, scrub(data, parity, parityCount, shardSize, corrupt,
+                true, ctx));
     }
     /* Must swap rows of encoded data putting identity rows in their proper places
-     * and filling missed rows with encoding matrix before calling this method
-     * if not, the encoded matrix will have no valid LU factorization.
+     * and filling missed rows with FEC rows before calling this method,
+     * the rows with indexArray[i] != i are the missing ones.
      * For example:
      * A encoding matrix and data like this
      * ----------------------------------------------------
@@ -174,49 +485,412 @@ public:
      * D4
      * ----------------------------------------------------
      * And indexArray parameter should be [0, 4(or 5), 2, 3]
+     * The Shard overload of decode takes the rows in any order without copying.
      *  */
     int decode(const unsigned char *encode, const unsigned int *indexArray,
             unsigned char *data, unsigned int dataLineSize) {
-        if (m_error == e_rscode_sts_init
-                || m_error == e_rscode_sts_construct_err) {
-            cout << "Encoding line size error. Check the encodeLineSize parameter of constructor." << endl;
-            return -1;
+        return report(decode(encode, indexArray, data, dataLineSize, m_context));
+    }
+    E_RSCODE_STS decode(const unsigned char *encode,
+            const unsigned int *indexArray, unsigned char *data,
+            unsigned int dataLineSize, Context &ctx) const {
+        E_RSCODE_STS sts = reconstruct(encode, indexArray, data, dataLineSize, ctx);
+        if (sts == e_rscode_sts_ok) {
+            for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+                if (indexArray[i] == i) {
+                    memcpy(data + i * dataLineSize, encode + i * dataLineSize,
+                            dataLineSize);
+                }
+            }
         }
-        if (dataLineSize == 0) {
-            m_error = e_rscode_sts_decoding_err;
-            cout << "dataLineSize line size error. It should greater then 0." << endl;
-            return -1;
+        return sts;
+    }
+    /* Same as decode, but only the missing lines of data are written and
+     * only their rows of the decoding matrix are calculated.
+     * With one missing line, this is one dot product over the encoded rows.
+     *  */
+    int reconstruct(const unsigned char *encode, const unsigned int *indexArray,
+            unsigned char *data, unsigned int dataLineSize) {
+        return report(reconstruct(encode, indexArray, data, dataLineSize, m_context));
+    }
+    E_RSCODE_STS reconstruct(const unsigned char *encode,
+            const unsigned int *indexArray, unsigned char *data,
+            unsigned int dataLineSize, Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (dataLineSize == 0 || dataLineSize % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+            if (indexArray[i] >= m_limit) {
+                return status(ctx, e_rscode_sts_index_err);
+            }
         }
 
-        /* Calculate the inverse matrix of encoding matrix using LU factorization */
-        LUFactorization(indexArray);
-        inverseEncodeMatrix();
-        /* Calculate missing lines using inverse matrix */
-        T *tEncode = new T[m_encodeLineSize * dataLineSize];
-        T *tData = new T[m_encodeLineSize * dataLineSize];
+        /* Get the decoding rows of the missing lines for this pattern */
+        reserve(ctx);
+        ctx.m_index.assign(indexArray, indexArray + m_encodeLineSize);
+        const DecodePlan *plan = decodePlan(ctx.m_index, ctx);
+        if (!plan) {
+            return status(ctx, e_rscode_sts_singular_err);
+        }
+        /* Calculate missing lines */
+        for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+            ctx.m_src[i] = encode + i * dataLineSize;
+        }
+        for (unsigned int i = 0; i < plan->m_missing.size(); ++i) {
+            ctx.m_dst[i] = data + plan->m_missing[i] * dataLineSize;
+        }
+        decodePass(*plan, ctx.m_src.data(), ctx.m_dst.data(), dataLineSize);
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* Scatter/gather decoding.
+     * shards are shardCount (>= encodeLineSize) encoded shards in any order,
+     * they are used in place and never copied. data[i] receives data line i
+     * if it is missing from shards, present lines are not written and their
+     * data[i] may be NULL. Every shard is shardSize bytes.
+     * Present data shards are preferred, missing lines are filled with the
+     * FEC shards of lowest index, so patterns map onto the same cached
+     * decoding rows whatever the order of shards.
+     *  */
+    int decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize) {
+        return report(decode(shards, shardCount, data, shardSize, m_context));
+    }
+    E_RSCODE_STS decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize, Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (shardSize == 0 || shardSize % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        reserve(ctx);
+        const DecodePlan *plan = selectShards(shards, shardCount, ctx.m_src.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        for (unsigned int i = 0; i < plan->m_missing.size(); ++i) {
+            ctx.m_dst[i] = data[plan->m_missing[i]];
+            if (ctx.m_dst[i] == NULL) {
+                return status(ctx, e_rscode_sts_output_err);
+            }
+        }
+        decodePass(*plan, ctx.m_src.data(), ctx.m_dst.data(), shardSize);
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* Decode and checksum in the same pass: crc[i] receives the CRC-32C of
+     * data line i (0 <= i < encodeLineSize), present or rebuilt, so the
+     * checksums stored at encoding validate the whole decode end to end.
+     *  */
+    int decodeCrc(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize, std::uint32_t *crc) {
+        return report(decodeCrc(shards, shardCount, data, shardSize, crc, m_context));
+    }
+    E_RSCODE_STS decodeCrc(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize, std::uint32_t *crc,
+            Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (shardSize == 0 || shardSize % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        reserve(ctx);
+        const DecodePlan *plan = selectShards(shards, shardCount, ctx.m_src.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        const std::vector<unsigned int> &missing = plan->m_missing;
+        for (unsigned int i = 0; i < missing.size(); ++i) {
+            ctx.m_dst[i] = data[missing[i]];
+            if (ctx.m_dst[i] == NULL) {
+                return status(ctx, e_rscode_sts_output_err);
+            }
+        }
+        /* Present data lines are the plan's columns of the same index */
+        std::uint32_t *srcCrc = ctx.m_crc.data();
+        std::uint32_t *dstCrc = srcCrc + m_encodeLineSize;
+        std::fill(ctx.m_crc.begin(), ctx.m_crc.end(), 0);
+        {
+            RSstats::Scope scope(RSstats::e_rs_trace_decode,
+                    missing.size() * shardSize);
+            applyMatrix(plan->m_matrix.data(), missing.size(), ctx.m_src.data(),
+                    ctx.m_dst.data(), 0, shardSize, srcCrc, dstCrc);
+        }
         for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
-            for (unsigned int j = 0; j < dataLineSize; ++j) {
-                tEncode[i * dataLineSize + j] = T((unsigned int) encode[i * dataLineSize + j]);
+            crc[i] = srcCrc[i];
+        }
+        for (unsigned int i = 0; i < missing.size(); ++i) {
+            crc[missing[i]] = dstCrc[i];
+        }
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* Degraded read of the bytes [offset, offset + length) of data line
+     * `line` into out (length bytes). shards are as for the scatter/gather
+     * decode and point to the beginning of the shards, but only the same
+     * column range of the selected shards is read. A present line is
+     * copied, a missing one is one dot product of its cached decoding row,
+     * so a small read from a large lost shard costs only its own columns.
+     *  */
+    int decodeRange(const Shard *shards, unsigned int shardCount,
+            unsigned int line, unsigned char *out, size_t offset, size_t length) {
+        return report(decodeRange(shards, shardCount, line, out, offset,
+                length, m_context));
+    }
+    E_RSCODE_STS decodeRange(const Shard *shards, unsigned int shardCount,
+            unsigned int line, unsigned char *out, size_t offset, size_t length,
+            Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (line >= m_encodeLineSize) {
+            return status(ctx, e_rscode_sts_index_err);
+        }
+        if (length == 0 || offset % SYMBOL_SIZE != 0 || length % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        if (out == NULL) {
+            return status(ctx, e_rscode_sts_output_err);
+        }
+        for (unsigned int s = 0; s < shardCount; ++s) {
+            if (shards[s].index == line) {
+                memcpy(out, shards[s].data + offset, length);
+                return status(ctx, e_rscode_sts_ok);
             }
         }
-        matrixMultiplication(m_pEncodeInverseMatrix, m_encodeLineSize,
-                m_encodeLineSize, tEncode, m_encodeLineSize, dataLineSize,
-                tData);
-        for (unsigned int i = 0; i < m_encodeLineSize * dataLineSize; ++i) {
-            data[i] = value(tData[i], T_IS_FLOATING());
+        reserve(ctx);
+        const DecodePlan *plan = selectShards(shards, shardCount, ctx.m_src.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        const std::vector<unsigned int> &missing = plan->m_missing;
+        const unsigned int i = std::find(missing.begin(), missing.end(), line)
+                - missing.begin();
+        RSstats::Scope scope(RSstats::e_rs_trace_decode, length);
+        T::Region::dotProduct(out, ctx.m_src.data(), offset,
+                plan->m_matrix.data() + i * m_encodeLineSize, m_encodeLineSize,
+                length);
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* First half of scatter/gather decoding: select encodeLineSize shards
+     * and get their decoding rows. src receives the selected shards in the
+     * order of the plan's columns. Returns NULL on error. With a Context,
+     * the rows are kept in it until its next decoding.
+     *  */
+    DECODE_PLAN selectShards(const Shard *shards, unsigned int shardCount,
+            const unsigned char **src) {
+        if (selectShards(shards, shardCount, src, m_context) == NULL) {
+            report(m_context.m_error);
+            return DECODE_PLAN();
+        }
+        return m_context.m_plan;
+    }
+    const DecodePlan* selectShards(const Shard *shards, unsigned int shardCount,
+            const unsigned char **src, Context &ctx) const {
+        reserve(ctx);
+        const DecodePlan *plan = selectRows([shards](unsigned int s) {
+            return shards[s].index;
+        }, shardCount, ctx.m_pick.data(), ctx);
+        for (unsigned int j = 0; plan && j < m_encodeLineSize; ++j) {
+            src[j] = shards[ctx.m_pick[j]].data;
         }
-        return 0;
+        return plan;
+    }
+    /* Same selection by rows only: indices[0..shardCount-1] are the rows of
+     * the shards at hand, pick[j] receives the position in indices of the
+     * shard of the plan's column j (pick has encodeLineSize entries).
+     *  */
+    const DecodePlan* selectShards(const unsigned int *indices,
+            unsigned int shardCount, unsigned int *pick, Context &ctx) const {
+        return selectRows([indices](unsigned int s) {
+            return indices[s];
+        }, shardCount, pick, ctx);
+    }
+    /* Batched decoding of stripes which lost the same shards, as after a
+     * drive failure. indices[0..shardCount-1] are the rows of the shards
+     * present in every stripe, shards[s][i] is the shard of row indices[i]
+     * of stripe s, and data[s][i] receives data line i of stripe s if it
+     * is missing (as data of the scatter/gather decode).
+     * The shards are selected and the decoding rows are got once for the
+     * whole batch, then the stripes are decoded in one pass.
+     *  */
+    int decodeStripes(const unsigned int *indices, unsigned int shardCount,
+            const unsigned char * const * const *shards,
+            unsigned char * const * const *data, unsigned int stripeCount,
+            size_t shardSize) {
+        return report(decodeStripes(indices, shardCount, shards, data,
+                stripeCount, shardSize, m_context));
+    }
+    E_RSCODE_STS decodeStripes(const unsigned int *indices,
+            unsigned int shardCount, const unsigned char * const * const *shards,
+            unsigned char * const * const *data, unsigned int stripeCount,
+            size_t shardSize, Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            return status(ctx, m_state);
+        }
+        if (shardSize == 0 || shardSize % SYMBOL_SIZE != 0) {
+            return status(ctx, e_rscode_sts_size_err);
+        }
+        reserve(ctx);
+        const DecodePlan *plan = selectShards(indices, shardCount, ctx.m_pick.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        const std::vector<unsigned int> &missing = plan->m_missing;
+        for (unsigned int s = 0; s < stripeCount; ++s) {
+            for (unsigned int i = 0; i < missing.size(); ++i) {
+                if (data[s][missing[i]] == NULL) {
+                    return status(ctx, e_rscode_sts_output_err);
+                }
+            }
+        }
+        for (unsigned int s = 0; s < stripeCount; ++s) {
+            for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
+                ctx.m_src[j] = shards[s][ctx.m_pick[j]];
+            }
+            for (unsigned int i = 0; i < missing.size(); ++i) {
+                ctx.m_dst[i] = data[s][missing[i]];
+            }
+            decodePass(*plan, ctx.m_src.data(), ctx.m_dst.data(), shardSize);
+        }
+        return status(ctx, e_rscode_sts_ok);
+    }
+    /* Second half of scatter/gather decoding: dst[i] receives the missing
+     * line plan.m_missing[i], for the columns [offset, offset + length).
+     * Different column ranges can be decoded concurrently. As with the
+     * column ranges of encodeStripe, RSstats does not count them.
+     *  */
+    void applyPlan(const DecodePlan &plan, const unsigned char * const *src,
+            unsigned char * const *dst, size_t offset, size_t length) const {
+        applyMatrix(plan.m_matrix.data(), plan.m_missing.size(), src, dst,
+                offset, length);
     }
 
+    /* Size ctx for this codec (it is a no-op once it is) */
+    void reserve(Context &ctx) const {
+        ctx.m_index.reserve(m_encodeLineSize);
+        ctx.m_pick.resize(m_encodeLineSize);
+        ctx.m_src.resize(m_encodeLineSize);
+        ctx.m_dst.resize(m_encodeLineSize);
+        ctx.m_crc.resize(2 * m_encodeLineSize);
+    }
+
+    /* Decoding matrices are cached by index array (least recently used
+     * ones are dropped), so stripes sharing an erasure pattern skip the
+     * matrix inversion. */
+    void setDecodeCacheSize(size_t size) {
+        m_pDecodeCache->setCapacity(size);
+    }
+    unsigned long long decodeCacheHits(void) const {
+        return m_pDecodeCache->hits();
+    }
+    unsigned long long decodeCacheMisses(void) const {
+        return m_pDecodeCache->misses();
+    }
+
+    /* Encoding and decoding process the shards in tiles of columns, so the
+     * source and output slices of a tile stay in cache while every
+     * coefficient is applied and each source byte is read from memory
+     * once. tileSize 0 (the default) sizes the tiles for half of the L2
+     * cache, otherwise it is rounded up to 64 bytes.
+     * Set it before the codec is shared.
+     *  */
+    void setTileSize(size_t tileSize) {
+        m_tileSize = (tileSize + 63) / 64 * 64;
+    }
+    inline size_t tileSize(void) const {
+        return m_tileSize;
+    }
+    /* Tile of applying rows coefficient rows */
+    size_t tileLength(unsigned int rows) const {
+        if (m_tileSize != 0) {
+            return m_tileSize;
+        }
+        size_t tile = cacheSize() / 2 / (m_encodeLineSize + rows) / 64 * 64;
+        if (tile < MIN_TILE_SIZE) {
+            tile = MIN_TILE_SIZE;
+        } else if (tile > MAX_TILE_SIZE) {
+            tile = MAX_TILE_SIZE;
+        }
+        return tile;
+    }
+    /* L2 cache size (per core), from sysconf once */
+    static size_t cacheSize(void) {
+        static const size_t s_size = detectCacheSize();
+        return s_size;
+    }
+
+    /* Status of the construction or of the last call without Context */
     inline E_RSCODE_STS error(void) const {return m_error;};
+    /* Status of the construction only, for users sharing the codec */
+    inline E_RSCODE_STS state(void) const {return m_state;};
+    inline unsigned int encodeLineSize(void) const {return m_encodeLineSize;};
+    inline unsigned int limit(void) const {return m_limit;};
+    /* Element [row][column] of the encoding matrix: the identity, then
+     * the Cauchy rows 1/(x+y), x = row, y = column */
+    inline T coefficient(unsigned int row, unsigned int column) const {
+        if (row < m_encodeLineSize) {
+            return T(row == column ? 1 : 0);
+        }
+        return T(1) / (T(row) + T(column));
+    }
+    /* FEC row j (row encodeLineSize + j of the encoding matrix) as region
+     * coefficients, valid as long as the codec */
+    inline const SYMBOL* parityRow(unsigned int j) const {
+        return parityRows(j + 1) + j * m_encodeLineSize;
+    }
+    /* Calculate the inverse of a n x n matrix using Gauss-Jordan elimination,
+     * matrix is overwritten. Returns false if it is singular. */
+    static bool inverseMatrix(T *matrix, T *inverse, unsigned int n) {
+        const T t0(0);
+        const T t1(1);
+        for (unsigned int i = 0; i < n; ++i) {
+            for (unsigned int j = 0; j < n; ++j) {
+                inverse[i * n + j] = (i == j) ? t1 : t0;
+            }
+        }
+        for (unsigned int c = 0; c < n; ++c) {
+            unsigned int r = c;
+            while (r < n && matrix[r * n + c] == t0) {
+                ++r;
+            }
+            if (r == n) {
+                return false;
+            }
+            if (r != c) {
+                for (unsigned int j = 0; j < n; ++j) {
+                    std::swap(matrix[r * n + j], matrix[c * n + j]);
+                    std::swap(inverse[r * n + j], inverse[c * n + j]);
+                }
+            }
+            const T d = t1 / matrix[c * n + c];
+            for (unsigned int j = 0; j < n; ++j) {
+                matrix[c * n + j] = matrix[c * n + j] * d;
+                inverse[c * n + j] = inverse[c * n + j] * d;
+            }
+            for (r = 0; r < n; ++r) {
+                const T f = matrix[r * n + c];
+                if (r == c || f == t0) {
+                    continue;
+                }
+                for (unsigned int j = 0; j < n; ++j) {
+                    matrix[r * n + j] = matrix[r * n + j] - f * matrix[c * n + j];
+                    inverse[r * n + j] = inverse[r * n + j] - f * inverse[c * n + j];
+                }
+            }
+        }
+        return true;
+    }
 
     /* Wrappers for T */
 private:
     /* value of T type object */
-    inline unsigned char value(const T& t, true_type) const {
-        return (unsigned char) t;
+    inline SYMBOL value(const T& t, true_type) const {
+        return (SYMBOL) t;
     }
-    inline unsigned char value(const T& t, false_type) const {
+    inline SYMBOL value(const T& t, false_type) const {
         return t.value();
     }
     /* output method of T type object */
@@ -236,214 +910,498 @@ private:
 
     /* Internal methods */
 private:
-    /* Value of p[row][column] */
-    inline T* position(T* p, unsigned int row, unsigned column) const {
-        return p + row * m_encodeLineSize + column;
-    }
-    /* LUFactorization using iteration */
-    void LUFactorization(const unsigned int *pByteIndexArray) {
-        T t;
-        unsigned int curIndex;
-        for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
-            curIndex = *(pByteIndexArray + i);
-            for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
-                *position(m_pEncodeMatrix, i, j) =
-                        *position(m_pCauchyMatrix, curIndex, j); /* original matrix */
+    E_RSCODE_STS checkEncode(unsigned int parityCount, size_t offset,
+            size_t length) const {
+        if (m_state != e_rscode_sts_ok) {
+            return m_state;
+        }
+        if (parityCount > m_limit - m_encodeLineSize) {
+            return e_rscode_sts_limit_err;
+        }
+        if (offset % SYMBOL_SIZE != 0 || length % SYMBOL_SIZE != 0) {
+            return e_rscode_sts_size_err;
+        }
+        return e_rscode_sts_ok;
+    }
+    /* Decoding pass of the whole length of a stripe, counted as one */
+    void decodePass(const DecodePlan &plan, const unsigned char * const *src,
+            unsigned char * const *dst, size_t length) const {
+        RSstats::Scope scope(RSstats::e_rs_trace_decode,
+                plan.m_missing.size() * length);
+        applyMatrix(plan.m_matrix.data(), plan.m_missing.size(), src, dst,
+                0, length);
+    }
+    /* FEC rows 0..count-1 (rows encodeLineSize.. of the encoding matrix) as
+     * region coefficients, count <= limit - encodeLineSize */
+    inline const SYMBOL* parityRows(unsigned int count) const {
+        const CauchyRows *rows = m_pRows.load(std::memory_order_acquire);
+        if (rows->m_count >= count) {
+            return rows->m_bytes;
+        }
+        std::lock_guard<std::mutex> lock(m_rowsMutex);
+        rows = m_pRows.load(std::memory_order_relaxed);
+        if (rows->m_count < count) {
+            unsigned int n = 2 * rows->m_count;
+            if (n < count) {
+                n = count;
             }
+            if (n > m_limit - m_encodeLineSize) {
+                n = m_limit - m_encodeLineSize;
+            }
+            rows = grow(n);
+            m_pRows.store(rows, std::memory_order_release);
         }
-
-        for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+        return rows->m_bytes;
+    }
+    /* A generation of count FEC rows (the rows before are copied from the
+     * last one), owned by m_rows. m_bytes is NULL if no memory is left. */
+    const CauchyRows* grow(unsigned int count) const {
+        CauchyRows *rows = new CauchyRows;
+        const size_t n = (size_t) count * m_encodeLineSize;
+        rows->m_arena = Arena(Arena::bytes(sizeof(SYMBOL), n), m_hugePages);
+        rows->m_bytes = rows->m_arena.template alloc<SYMBOL>(n);
+        rows->m_count = rows->m_bytes != NULL ? count : 0;
+        unsigned int first = 0;
+        if (!m_rows.empty() && rows->m_count > 0) {
+            first = m_rows.back()->m_count;
+            memcpy(rows->m_bytes, m_rows.back()->m_bytes,
+                    (size_t) first * m_encodeLineSize * sizeof(SYMBOL));
+        }
+        for (unsigned int r = first; r < rows->m_count; ++r) {
             for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
-                if (i == 0) {
-                    *position(m_pU, 0, j) = *position(m_pEncodeMatrix, 0, j);
-                    *position(m_pL, j, 0) = (*position(m_pEncodeMatrix, j, 0))
-                            / (*position(m_pEncodeMatrix, 0, 0));
-                } else {
-                    if (i <= j) {
-                        /* calculate u[i][j] */
-                        t = T(0);
-                        for (unsigned int k = 0; k < i; ++k) {
-                            t = t + (*position(m_pL, i, k)) * (*position(m_pU, k, j));
-                        }
-                        *position(m_pU, i, j) = *position(m_pEncodeMatrix, i, j) - t;
-
-                        /* calculate l[j][i] */
-                        if (i == j) {
-                            *position(m_pL, j, i) = T(1);
-                        } else {
-                            t = T(0);
-                            for (unsigned int k = 0; k < i; ++k) {
-                                t = t + (*position(m_pL, j, k)) * (*position(m_pU, k, i));
-                            }
-                            *position(m_pL, j, i) = (*position(m_pEncodeMatrix, j, i) - t)
-                                    / (*position(m_pU, i, i));
-                        }
-                    } else {
-                        *position(m_pU, i, j) = T(0);
-                        *position(m_pL, j, i) = T(0);
-                    }
-                }
+                rows->m_bytes[r * m_encodeLineSize + j] = value(
+                        coefficient(m_encodeLineSize + r, j), T_IS_FLOATING());
             }
         }
+        m_rows.push_back(std::unique_ptr<const CauchyRows>(rows));
+        return rows;
     }
-    /* Calculate the inverse matrix of L using iteration */
-    void inverseLMatrix(void) {
-        const T t0(0);
-        const T t1(1);
+    /* Keep sts as the status of ctx */
+    inline E_RSCODE_STS status(Context &ctx, E_RSCODE_STS sts) const {
+        ctx.m_error = sts;
+        return sts;
+    }
+    /* Status of a call without Context as 0 or -1, printing the error */
+    int report(E_RSCODE_STS sts) {
+        if (sts == e_rscode_sts_ok) {
+            return 0;
+        }
+        m_error = sts;
+        cout << errorString(sts) << endl;
+        return -1;
+    }
+    /* Unique codec identity, 0 is none */
+    static unsigned long long newId(void) {
+        static std::atomic<unsigned long long> s_lastId(0);
+        return s_lastId.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    /* Release the FEC rows and the decode cache */
+    void destroy(void) {
+        m_pRows.store(NULL);
+        m_rows.clear();
+        if (m_pDecodeCache)
+            delete m_pDecodeCache;
+        m_pDecodeCache = NULL;
+    }
+    static size_t detectCacheSize(void) {
+        long size = -1;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        if (size <= 0) {
+            return CACHE_SIZE;
+        }
+        return size;
+    }
+    /* Select encodeLineSize of shardCount shards, row(s) is the row of
+     * shard s, and get their decoding rows. pick[j] receives the shard of
+     * the plan's column j. Present data shards are preferred, missing lines
+     * are filled with the FEC shards of lowest row, so patterns map onto the
+     * same cached decoding rows whatever the order of shards.
+     *  */
+    template<typename ROW>
+    const DecodePlan* selectRows(ROW row, unsigned int shardCount,
+            unsigned int *pick, Context &ctx) const {
+        if (m_state != e_rscode_sts_ok) {
+            status(ctx, m_state);
+            return NULL;
+        }
+        /* Select data shards in their own places */
+        reserve(ctx);
+        std::vector<unsigned int> &index = ctx.m_index;
+        index.assign(m_encodeLineSize, m_limit);
+        for (unsigned int s = 0; s < shardCount; ++s) {
+            const unsigned int r = row(s);
+            if (r >= m_limit) {
+                status(ctx, e_rscode_sts_index_err);
+                return NULL;
+            }
+            if (r < m_encodeLineSize) {
+                index[r] = r;
+                pick[r] = s;
+            }
+        }
+        /* Fill missing lines with FEC shards in ascending row order */
+        unsigned int last = m_encodeLineSize - 1;
         for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
-            for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
-                if (i < j) {
-                    *position(m_pLInverseMatrix, i, j) = t0;
-                } else if (i == j) {
-                    *position(m_pLInverseMatrix, i, j) = t1;
-                } else {
-                    T r(0);
-                    for (unsigned int k = j; k < i; ++k) {
-                        r = r + (*position(m_pL, i, k)) * (*position(m_pLInverseMatrix, k, j));
-                    }
-                    *position(m_pLInverseMatrix, i, j) = t0 - r;
+            if (index[i] != m_limit) {
+                continue;
+            }
+            for (unsigned int s = 0; s < shardCount; ++s) {
+                const unsigned int r = row(s);
+                if (r > last && r < index[i]) {
+                    index[i] = r;
+                    pick[i] = s;
                 }
             }
+            if (index[i] == m_limit) {
+                status(ctx, e_rscode_sts_shards_err);
+                return NULL;
+            }
+            last = index[i];
         }
+        const DecodePlan *plan = decodePlan(index, ctx);
+        status(ctx, plan ? e_rscode_sts_ok : e_rscode_sts_singular_err);
+        return plan;
     }
-    /* Calculate the inverse matrix of U using iteration */
-    void inverseUMatrix(void) {
-        const T t0(0);
-        const T t1(1);
-        for (int i = m_encodeLineSize - 1; i >= 0; --i) {
-            for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
-                if (i > j) {
-                    *position(m_pUInverseMatrix, i, j) = t0;
-                } else if (i == j) {
-                    *position(m_pUInverseMatrix, i, j) = t1
-                            / (*position(m_pU, i, i));
-                } else {
-                    T r(0);
-                    for (unsigned int k = j; k > i; --k) {
-                        r = r + (*position(m_pU, i, k)) * (*position(m_pUInverseMatrix, k, j));
-                    }
-                    *position(m_pUInverseMatrix, i, j) = (t0 - r)  / (*position(m_pU, i, i));
+    /* verify and repair */
+    E_RSCODE_STS scrub(const unsigned char * const *data,
+            const unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, unsigned int *corrupt, bool fix,
+            Context &ctx) const {
+        if (corrupt != NULL) {
+            *corrupt = m_limit;
+        }
+        if (m_state != e_rscode_sts_ok) {
+            return m_state;
+        }
+        if (parityCount > m_limit - m_encodeLineSize) {
+            return e_rscode_sts_limit_err;
+        }
+        if (shardSize % SYMBOL_SIZE != 0) {
+            return e_rscode_sts_size_err;
+        }
+        if (parityCount == 0) {
+            return e_rscode_sts_ok;
+        }
+        /* Check row: r^j for parity j, sum(r^j x C[encodeLineSize + j][i])
+         * for data i, with the first r making every coefficient non-zero */
+        const unsigned int k = m_encodeLineSize;
+        const unsigned int n = k + parityCount;
+        ctx.m_check.resize(n);
+        ctx.m_src.resize(n);
+        bool found = false;
+        for (unsigned int r = 1; !found && r < m_limit; ++r) {
+            T power(1);
+            found = true;
+            for (unsigned int j = 0; j < parityCount; ++j) {
+                ctx.m_check[k + j] = value(power, T_IS_FLOATING());
+                power = power * T(r);
+            }
+            for (unsigned int i = 0; i < k && found; ++i) {
+                T t(0);
+                power = T(1);
+                for (unsigned int j = 0; j < parityCount; ++j) {
+                    t = t + power * coefficient(k + j, i);
+                    power = power * T(r);
+                }
+                ctx.m_check[i] = value(t, T_IS_FLOATING());
+                found = t != T(0);
+            }
+        }
+        for (unsigned int i = 0; i < n; ++i) {
+            ctx.m_src[i] = (i < k) ? data[i] : parity[i - k];
+        }
+        /* Streaming pass */
+        unsigned char syn[COLUMN_BLOCK_SIZE];
+        size_t offset = 0;
+        for (; offset < shardSize; offset += COLUMN_BLOCK_SIZE) {
+            const size_t len = blockLength(offset, shardSize);
+            if (found) {
+                T::Region::dotProduct(syn, ctx.m_src.data(), offset,
+                        ctx.m_check.data(), n, len);
+                if (isZero(syn, len)) {
+                    continue;
                 }
+            } else if (consistent(m_limit, data, parity, parityCount, offset,
+                    len)) {
+                continue;
             }
+            break;
+        }
+        if (offset >= shardSize) {
+            return e_rscode_sts_ok;
+        }
+        /* Locate the shard from the first inconsistent block, then check it
+         * over the stripe */
+        if (parityCount < 2) {
+            return e_rscode_sts_uncorrectable_err;
+        }
+        const size_t len = blockLength(offset, shardSize);
+        unsigned int row = 0;
+        while (row < n && !consistent(row, data, parity, parityCount, offset,
+                len)) {
+            ++row;
+        }
+        for (offset = 0; row < n && offset < shardSize;
+                offset += COLUMN_BLOCK_SIZE) {
+            if (!consistent(row, data, parity, parityCount, offset,
+                    blockLength(offset, shardSize))) {
+                row = n;
+            }
+        }
+        if (row == n) {
+            return e_rscode_sts_uncorrectable_err;
+        }
+        if (corrupt != NULL) {
+            *corrupt = row;
+        }
+        if (!fix) {
+            return e_rscode_sts_corrupt_err;
+        }
+        /* The corrupt shard minus its error */
+        const unsigned int j = (row < k) ? 0 : row - k;
+        const SYMBOL c = (row < k) ? value(T(1) / coefficient(k, row),
+                T_IS_FLOATING()) : 1;
+        unsigned char *dst = const_cast<unsigned char *>(ctx.m_src[row]);
+        for (offset = 0; offset < shardSize; offset += COLUMN_BLOCK_SIZE) {
+            const size_t len = blockLength(offset, shardSize);
+            syndrome(j, data, parity, offset, len, syn);
+            T::Region::multiplyAdd(dst + offset, syn, c, len);
+        }
+        return e_rscode_sts_ok;
+    }
+    /* Whether the block [offset, offset + len) is consistent if only the
+     * shard of row is corrupt (m_limit: none is).
+     * Data row i with error E gives S[j] = C[encodeLineSize + j][i] x E,
+     * FEC row j0 gives S[j0] = E and no other non-zero syndrome.
+     *  */
+    bool consistent(unsigned int row, const unsigned char * const *data,
+            const unsigned char * const *parity, unsigned int parityCount,
+            size_t offset, size_t len) const {
+        unsigned char syn[COLUMN_BLOCK_SIZE];
+        unsigned char err[COLUMN_BLOCK_SIZE];
+        const unsigned int k = m_encodeLineSize;
+        if (row < k) {
+            /* E = S[0] / C[k][row] */
+            syndrome(0, data, parity, offset, len, syn);
+            T::Region::multiply(err, syn, value(T(1) / coefficient(k, row),
+                    T_IS_FLOATING()), len);
+        }
+        for (unsigned int j = (row < k) ? 1 : 0; j < parityCount; ++j) {
+            if (k + j == row) {
+                continue;
+            }
+            syndrome(j, data, parity, offset, len, syn);
+            if (row < k) {
+                T::Region::multiplyAdd(syn, err, value(coefficient(k + j, row),
+                        T_IS_FLOATING()), len);
+            }
+            if (!isZero(syn, len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /* syn = S[j] of the block [offset, offset + len) */
+    void syndrome(unsigned int j, const unsigned char * const *data,
+            const unsigned char * const *parity, size_t offset, size_t len,
+            unsigned char *syn) const {
+        T::Region::dotProduct(syn, data, offset,
+                parityRow(j), m_encodeLineSize, len);
+        T::Region::multiplyAdd(syn, parity[j] + offset, 1, len);
+    }
+    inline size_t blockLength(size_t offset, size_t length) const {
+        if (length - offset < COLUMN_BLOCK_SIZE) {
+            return length - offset;
+        }
+        return COLUMN_BLOCK_SIZE;
+    }
+    static bool isZero(const unsigned char *p, size_t len) {
+        unsigned long long acc = 0;
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+            unsigned long long v;
+            memcpy(&v, p + i, 8);
+            acc |= v;
+        }
+        for (; i < len; ++i) {
+            acc |= p[i];
+        }
+        return acc == 0;
+    }
+    /* Parameter check of updateParity */
+    E_RSCODE_STS checkUpdate(unsigned int dataIndex, unsigned int parityCount,
+            size_t offset, size_t length) const {
+        if (m_state != e_rscode_sts_ok) {
+            return m_state;
+        }
+        if (dataIndex >= m_encodeLineSize) {
+            return e_rscode_sts_index_err;
+        }
+        if (parityCount > m_limit - m_encodeLineSize) {
+            return e_rscode_sts_limit_err;
+        }
+        if (offset % SYMBOL_SIZE != 0 || length % SYMBOL_SIZE != 0) {
+            return e_rscode_sts_size_err;
         }
+        return e_rscode_sts_ok;
     }
-    int matrixMultiplication(T *x, unsigned int xSizeI, unsigned int xSizeJ,
-            T *y, unsigned int ySizeI, unsigned int ySizeJ, T *r) {
-        if (xSizeJ != ySizeI) {
-            return -1;
+    /* Decoding rows of the missing lines of indexArray, from ctx, from the
+     * shared cache or calculated, and kept in ctx: the rows stay valid
+     * until the next decoding with ctx. Returns NULL if the rows can not be
+     * decoded.
+     * Let M be the missing lines, S the present ones and P the FEC rows
+     * filling M. Each FEC row is C[p]xD = C[p][S]xD[S] + C[p][M]xD[M], so
+     * D[M] = Inverse(C[P][M])x(E[P] - C[P][S]xD[S])
+     * and only the |M|x|M| matrix C[P][M] needs to be inverted.
+     *  */
+    const DecodePlan* decodePlan(const std::vector<unsigned int> &indexArray,
+            Context &ctx) const {
+        if (ctx.m_plan && ctx.m_planCode == m_id && ctx.m_planIndex == indexArray) {
+            RSstats::add(RSstats::e_rs_stat_plan_hits);
+            return ctx.m_plan.get();
+        }
+        DECODE_PLAN plan = m_pDecodeCache->get(indexArray);
+        if (plan) {
+            RSstats::add(RSstats::e_rs_stat_plan_hits);
+            return keepPlan(indexArray, std::move(plan), ctx);
+        }
+        RSstats::add(RSstats::e_rs_stat_plan_misses);
+        RSstats::Scope scope(RSstats::e_rs_trace_invert, 0);
+        DecodePlan *p = new DecodePlan;
+        for (unsigned int i = 0; i < m_encodeLineSize; ++i) {
+            if (indexArray[i] != i) {
+                p->m_missing.push_back(i);
+            }
+        }
+        unsigned int n = p->m_missing.size();
+        std::vector<T> sub(n * n);
+        std::vector<T> inv(n * n);
+        for (unsigned int a = 0; a < n; ++a) {
+            for (unsigned int b = 0; b < n; ++b) {
+                sub[a * n + b] = coefficient(indexArray[p->m_missing[a]],
+                        p->m_missing[b]);
+            }
+        }
+        if (!inverseMatrix(sub.data(), inv.data(), n)) {
+            delete p;
+            return NULL;
         }
-        const T t(0);
-        for (unsigned i = 0; i < xSizeI; ++i) {
-            for (unsigned j = 0; j < ySizeJ; ++j) {
-                *position(r, i, j) = t;
-                for (unsigned k = 0; k < xSizeJ; ++k) {
-                    *position(r, i, j) = (*position(r, i, j))
-                            + (*position(x, i, k)) * (*position(y, k, j));
+        p->m_matrix.resize(n * m_encodeLineSize);
+        for (unsigned int a = 0; a < n; ++a) {
+            for (unsigned int b = 0, j = 0; j < m_encodeLineSize; ++j) {
+                T t(0);
+                if (indexArray[j] != j) {
+                    t = inv[a * n + b++];   /* FEC row of missing line j */
+                } else {
+                    for (unsigned int c = 0; c < n; ++c) {
+                        t = t + inv[a * n + c] * coefficient(
+                                indexArray[p->m_missing[c]], j);
+                    }
                 }
+                p->m_matrix[a * m_encodeLineSize + j] = value(t, T_IS_FLOATING());
             }
         }
-        return 0;
+        RSstats::add(RSstats::e_rs_stat_allocations);
+        RSstats::add(RSstats::e_rs_stat_allocated_bytes, p->m_matrix.size() * SYMBOL_SIZE);
+        plan.reset(p);
+        m_pDecodeCache->put(indexArray, plan);
+        return keepPlan(indexArray, std::move(plan), ctx);
     }
-    void inverseEncodeMatrix(void) {
-        /* Encoding matrix(A) = LxU
-         * Decoding matrix(Inverse(A)) = Inverse(U)xInverse(L)
-         *  */
-        inverseLMatrix();
-        inverseUMatrix();
-        matrixMultiplication(m_pUInverseMatrix, m_encodeLineSize,
-                m_encodeLineSize, m_pLInverseMatrix, m_encodeLineSize,
-                m_encodeLineSize, m_pEncodeInverseMatrix);
+    const DecodePlan* keepPlan(const std::vector<unsigned int> &indexArray,
+            DECODE_PLAN plan, Context &ctx) const {
+        ctx.m_planIndex.assign(indexArray.begin(), indexArray.end());
+        ctx.m_plan = std::move(plan);
+        ctx.m_planCode = m_id;
+        return ctx.m_plan.get();
+    }
+    /* dst[r] = matrix[r][0] * src[0] + ... (0 <= r < rows)
+     * matrix is rows x encodeLineSize coefficients, the columns
+     * [offset, offset + length) of the shards are processed in tiles.
+     * If srcCrc and dstCrc are given, the CRC-32C of every source and
+     * destination is extended by each tile while the tile is in cache. */
+    void applyMatrix(const SYMBOL *matrix, unsigned int rows,
+            const unsigned char * const *src, unsigned char * const *dst,
+            size_t offset, size_t length, std::uint32_t *srcCrc = NULL,
+            std::uint32_t *dstCrc = NULL) const {
+        const size_t tile = tileLength(rows);
+        const size_t end = offset + length;
+        for (; offset < end; offset += tile) {
+            size_t len = end - offset;
+            if (len > tile) {
+                len = tile;
+            }
+            for (unsigned int r = 0; r < rows; ++r) {
+                T::Region::dotProduct(dst[r] + offset, src, offset,
+                        matrix + r * m_encodeLineSize, m_encodeLineSize, len);
+            }
+            if (srcCrc == NULL) {
+                continue;
+            }
+            for (unsigned int j = 0; j < m_encodeLineSize; ++j) {
+                srcCrc[j] = Crc32c::extend(srcCrc[j], src[j] + offset, len);
+            }
+            for (unsigned int r = 0; r < rows; ++r) {
+                dstCrc[r] = Crc32c::extend(dstCrc[r], dst[r] + offset, len);
+            }
+        }
     }
-
     /* Internal member */
 private:
-    unsigned int m_encodeLineSize;          /* Encoding matrix line size */
-    unsigned int m_limit;                   /* Encoding matrix limitation */
-    unsigned int m_curLine;                 /* Cursor */
-    T *m_pCauchyMatrix = NULL;              /* Cauchy matrix */
-    T *m_pL = NULL;                         /* Result of encoding matrix's LUFactorization  */
-    T *m_pU = NULL;                         /* Result of encoding matrix's LUFactorization  */
-    T *m_pLInverseMatrix = NULL;            /* Inverse matrix of L */
-    T *m_pUInverseMatrix = NULL;            /* Inverse matrix of U */
-    T *m_pEncodeMatrix = NULL;              /* Encoding matrix */
-    T *m_pEncodeInverseMatrix = NULL;       /* Inverse of Encoding matrix */
+    static const size_t COLUMN_BLOCK_SIZE = 8192;   /* Column block of updateParity and verify */
+    static const size_t MIN_TILE_SIZE = 1024;       /* Bounds of the automatic tile */
+    static const size_t MAX_TILE_SIZE = 65536;
+    static const size_t CACHE_SIZE = 256 << 10;     /* L2 cache if it is unknown */
+    static const size_t DECODE_CACHE_SIZE = 64;     /* Default decode cache entries */
+    unsigned int m_encodeLineSize = 0;      /* Encoding matrix line size */
+    unsigned int m_limit = 0;               /* Encoding matrix limitation */
+    bool m_hugePages = false;               /* Map the FEC rows from huge pages */
+    /* Generations of FEC rows (m_rows owns them all, readers use the last
+     * one through m_pRows, older ones stay valid until destruction) */
+    mutable std::atomic<const CauchyRows*> m_pRows{NULL};
+    mutable std::vector<std::unique_ptr<const CauchyRows> > m_rows;
+    mutable std::mutex m_rowsMutex;         /* Guards m_rows */
+    DECODE_CACHE *m_pDecodeCache = NULL;    /* Decoding matrices by index array */
+    unsigned long long m_id = 0;            /* Owner of the plans kept in Contexts */
+    size_t m_tileSize = 0;                  /* Columns of a tile, 0 is automatic */
+    E_RSCODE_STS m_state = e_rscode_sts_init;   /* Status of construction */
+    /* Calls without Context (not shared) */
+    Context m_context;                      /* Cursor and scratch space */
     E_RSCODE_STS m_error = e_rscode_sts_init;
 
 
     /* For debug */
 public:
-    void debug(void) {
-        const char *title[] = { "Cauchy Matrix", "L Matrix", "U Matrix",
-                "Inverse L Matrix", "Inverse U Matrix", "Encoding Matrix",
-                "Inverse Encoding Matrix",
-                NULL };
-        T *matrix[] = { m_pCauchyMatrix, m_pL, m_pU, m_pLInverseMatrix,
-                m_pUInverseMatrix, m_pEncodeMatrix, m_pEncodeInverseMatrix,
-                NULL };
-        unsigned int size[] = { m_limit, m_encodeLineSize, m_encodeLineSize,
-                m_encodeLineSize, m_encodeLineSize, m_encodeLineSize,
-                m_encodeLineSize, 0 };
-        for (unsigned int i = 0; title[i] != NULL; ++i) {
-            debug(title[i], matrix[i], size[i], m_encodeLineSize);
-        }
-        /* Verify if the LU factorization and inverse matrix was correct */
-        debugMatrixMultiplication("LxU Matrix:", m_pL, m_encodeLineSize,
-                m_encodeLineSize, m_pU, m_encodeLineSize, m_encodeLineSize);
-        debugMatrixMultiplication("LxLInvwese", m_pL, m_encodeLineSize,
-                m_encodeLineSize, m_pLInverseMatrix, m_encodeLineSize,
-                m_encodeLineSize);
-        debugMatrixMultiplication("UxUInvwese", m_pU, m_encodeLineSize,
-                m_encodeLineSize, m_pUInverseMatrix, m_encodeLineSize,
-                m_encodeLineSize);
-        debugMatrixMultiplication("AxAInverse", m_pEncodeMatrix,
-                m_encodeLineSize, m_encodeLineSize, m_pEncodeInverseMatrix,
-                m_encodeLineSize, m_encodeLineSize);
+    void debug(void) const {
+        if (m_state == e_rscode_sts_ok) {
+            debug("Cauchy Matrix", m_encodeLineSize + m_pRows.load()->m_count,
+                    m_encodeLineSize);
+        }
     }
     /* For debug */
 private:
-    void setupDebugFormat(std::ostream &s, streamsize width, char c, ios_base::fmtflags fmtfl) {
-        dbg_w = s.width();
-        s.width(3);
-        dbg_c = s.fill();
-        s.fill('0');
-        dbg_f = fmtfl;
-        s.setf(dbg_f, std::ios::basefield);
-    }
-    void clearDebugFormat(std::ostream &s) {
-        s.unsetf(dbg_f);
-        s.fill(dbg_c);
-        s.width(dbg_w);
-    }
-    void debug(const char *title, T *matrix, unsigned int sizeX, unsigned int sizeY) {
+    void debug(const char *title, unsigned int sizeX, unsigned int sizeY) const {
         cout << title << endl;
-        for (int i = 0; i < sizeX; ++i) {
+        for (unsigned int i = 0; i < sizeX; ++i) {
+            /* line number in 3 digits, then restore the stream format */
+            std::streamsize w = cout.width();
+            char c = cout.fill();
+            ios_base::fmtflags f = cout.flags();
             cout << "L";
-            setupDebugFormat(cout, 4, '0', std::ios::dec);
+            cout.width(3);
+            cout.fill('0');
+            cout.setf(std::ios::dec, std::ios::basefield);
             cout << i + 1 << ": ";
-            clearDebugFormat(cout);
-            for (int j = 0; j < sizeY; ++j) {
-                output(*position(matrix, i, j), cout, T_IS_FLOATING());
+            cout.flags(f);
+            cout.fill(c);
+            cout.width(w);
+            for (unsigned int j = 0; j < sizeY; ++j) {
+                output(coefficient(i, j), cout, T_IS_FLOATING());
             }
             cout << endl;
         }
     }
-    int debugMatrixMultiplication(const char *title, T *x, unsigned int xSizeI,
-            unsigned int xSizeJ, T *y, unsigned int ySizeI, unsigned int ySizeJ) {
-        int ret;
-        T *r = new T[xSizeJ * ySizeI];
-        ret = matrixMultiplication(x, xSizeI, xSizeJ, y, ySizeI, ySizeJ, r);
-        if (ret == 0) {
-            debug(title, r, xSizeI, ySizeJ);
-        } else {
-            cout << "debugMatrixMultiple error." << endl;
-        }
-        delete[] r;
-        return ret;
-    }
-private:
-    std::streamsize dbg_w;
-    char dbg_c;
-    ios_base::fmtflags dbg_f;
 };
 
 
@@ -0,0 +1,414 @@
+/*
+ * RScodeBench.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "GF28Value.hh"
+#include "GF28Region.hh"
+#include "RScode.hh"
+#include "RSengine.hh"
+#include "RSxorCode.hh"
+
+using namespace std;
+
+/* Encode/decode throughput and latency over a matrix of parameters.
+ * Every configuration runs warm-up iterations first, then repetitions which
+ * are timed one by one. Throughput counts the data bytes of the stripe
+ * (k x shard size) for both encoding and decoding.
+ *  */
+
+typedef enum {
+    e_format_text = 0,
+    e_format_csv,
+    e_format_json,
+} E_FORMAT;
+
+struct Options {
+    vector<unsigned int> m_k;
+    vector<unsigned int> m_m;
+    vector<size_t> m_size;
+    vector<unsigned int> m_erasures;            /* 0 means m */
+    vector<unsigned int> m_threads;
+    vector<GF28Region::E_GF28_KERNEL> m_kernels;
+    bool m_xor;                                 /* Also run RSxorCode (single thread) */
+    size_t m_tileSize;                          /* RScode tile, 0 is automatic */
+    unsigned int m_warmup;
+    unsigned int m_minReps;
+    unsigned int m_maxReps;
+    size_t m_bytesPerConfig;                    /* Data bytes timed per configuration */
+    E_FORMAT m_format;
+};
+
+struct Result {
+    const char *m_op;
+    const char *m_kernel;
+    unsigned int m_k;
+    unsigned int m_m;
+    unsigned int m_erasures;
+    unsigned int m_threads;
+    size_t m_size;
+    unsigned int m_reps;
+    double m_gbps;
+    double m_p50;                               /* Latencies in microseconds */
+    double m_p90;
+    double m_p99;
+    double m_max;
+};
+
+typedef chrono::steady_clock CLOCK;
+
+static double percentile(const vector<double> &sorted, double p) {
+    size_t i = (size_t) (p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+/* Time func reps times after warmup calls */
+template<typename F>
+static void measure(const Options &opt, size_t bytes, F func, Result &r) {
+    unsigned int reps = opt.m_bytesPerConfig / bytes;
+    reps = max(opt.m_minReps, min(opt.m_maxReps, reps));
+    for (unsigned int i = 0; i < opt.m_warmup; ++i) {
+        func();
+    }
+    vector<double> lat(reps);
+    double total = 0;
+    for (unsigned int i = 0; i < reps; ++i) {
+        CLOCK::time_point t0 = CLOCK::now();
+        func();
+        CLOCK::time_point t1 = CLOCK::now();
+        lat[i] = chrono::duration<double, micro>(t1 - t0).count();
+        total += lat[i];
+    }
+    sort(lat.begin(), lat.end());
+    r.m_reps = reps;
+    r.m_gbps = (double) bytes * reps / (total * 1e3);    /* bytes/us -> GB/s */
+    r.m_p50 = percentile(lat, 0.50);
+    r.m_p90 = percentile(lat, 0.90);
+    r.m_p99 = percentile(lat, 0.99);
+    r.m_max = lat.back();
+}
+
+static void output(const Options &opt, const Result &r, bool first) {
+    if (opt.m_format == e_format_csv) {
+        if (first) {
+            cout << "op,kernel,k,m,erasures,threads,shard_size,reps,gbps,p50_us,p90_us,p99_us,max_us" << endl;
+        }
+        cout << r.m_op << "," << r.m_kernel << "," << r.m_k << "," << r.m_m << ","
+                << r.m_erasures << "," << r.m_threads << "," << r.m_size << ","
+                << r.m_reps << "," << r.m_gbps << "," << r.m_p50 << "," << r.m_p90
+                << "," << r.m_p99 << "," << r.m_max << endl;
+    } else if (opt.m_format == e_format_json) {
+        cout << (first ? "[\n" : ",\n") << "  {\"op\": \"" << r.m_op
+                << "\", \"kernel\": \"" << r.m_kernel << "\", \"k\": " << r.m_k
+                << ", \"m\": " << r.m_m << ", \"erasures\": " << r.m_erasures
+                << ", \"threads\": " << r.m_threads << ", \"shard_size\": " << r.m_size
+                << ", \"reps\": " << r.m_reps << ", \"gbps\": " << r.m_gbps
+                << ", \"p50_us\": " << r.m_p50 << ", \"p90_us\": " << r.m_p90
+                << ", \"p99_us\": " << r.m_p99 << ", \"max_us\": " << r.m_max << "}";
+    } else {
+        if (first) {
+            cout << "op      kernel       k   m   e   thr  shard_size   reps    GB/s     p50(us)    p90(us)    p99(us)" << endl;
+        }
+        cout.setf(ios::left, ios::adjustfield);
+        cout.width(8);
+        cout << r.m_op;
+        cout.width(13);
+        cout << r.m_kernel;
+        cout.width(4);
+        cout << r.m_k;
+        cout.width(4);
+        cout << r.m_m;
+        cout.width(4);
+        cout << r.m_erasures;
+        cout.width(6);
+        cout << r.m_threads;
+        cout.width(13);
+        cout << r.m_size;
+        cout.width(8);
+        cout << r.m_reps;
+        cout.width(9);
+        cout << r.m_gbps;
+        cout.width(11);
+        cout << r.m_p50;
+        cout.width(11);
+        cout << r.m_p90;
+        cout << r.m_p99 << endl;
+        cout.unsetf(ios::adjustfield);
+    }
+}
+
+typedef RScode<GF28Value>::Shard Shard;
+
+/* Encode, then decode every erasure count of the options, with
+ * encode(data, parity) and decode(shards, out) of one code */
+template<typename ENCODE, typename DECODE>
+static bool runCode(const Options &opt, unsigned int k, unsigned int m,
+        size_t size, const char *kernel, unsigned int threads,
+        ENCODE encode, DECODE decode, bool &first) {
+    vector<unsigned char> buf((k + m) * size);
+    vector<unsigned char> recover(m * size);
+    vector<const unsigned char*> data(k);
+    vector<unsigned char*> parity(m);
+    for (size_t i = 0; i < k * size; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < k; ++i) {
+        data[i] = &buf[i * size];
+    }
+    for (unsigned int i = 0; i < m; ++i) {
+        parity[i] = &buf[(k + i) * size];
+    }
+
+    Result r;
+    r.m_kernel = kernel;
+    r.m_k = k;
+    r.m_m = m;
+    r.m_threads = threads;
+    r.m_size = size;
+
+    r.m_op = "encode";
+    r.m_erasures = 0;
+    measure(opt, k * size, [&] {
+        encode(data.data(), parity.data());
+    }, r);
+    output(opt, r, first);
+    first = false;
+
+    bool res = true;
+    for (size_t e = 0; e < opt.m_erasures.size(); ++e) {
+        unsigned int erasures = (opt.m_erasures[e] == 0) ? m : opt.m_erasures[e];
+        if (erasures > m || erasures > k) {
+            continue;
+        }
+        /* lose the first data shards, use the first FEC shards instead */
+        vector<Shard> shards(k);
+        vector<unsigned char*> out(k, (unsigned char*) NULL);
+        for (unsigned int i = 0; i < k; ++i) {
+            shards[i].index = (i < erasures) ? k + i : i;
+            shards[i].data = &buf[shards[i].index * size];
+            if (i < erasures) {
+                out[i] = &recover[i * size];
+            }
+        }
+        r.m_op = "decode";
+        r.m_erasures = erasures;
+        measure(opt, k * size, [&] {
+            decode(shards.data(), out.data());
+        }, r);
+        if (memcmp(&recover[0], &buf[0], erasures * size) != 0) {
+            cerr << "decode verify error" << endl;
+            res = false;
+        }
+        output(opt, r, first);
+    }
+    return res;
+}
+
+static bool runConfig(const Options &opt, unsigned int k, unsigned int m,
+        size_t size, unsigned int threads, GF28Region::E_GF28_KERNEL kernel,
+        bool &first) {
+    RScode<GF28Value> rs(k, size);
+    rs.setTileSize(opt.m_tileSize);
+    if (threads > 1) {
+        RSengine<GF28Value> engine(rs, threads);
+        return runCode(opt, k, m, size, GF28Region::kernelName(kernel), threads,
+                [&](const unsigned char * const *data, unsigned char * const *parity) {
+                    engine.encodeStripe(data, parity, m, size);
+                }, [&](const Shard *shards, unsigned char * const *out) {
+                    engine.decode(shards, k, out, size);
+                }, first);
+    }
+    return runCode(opt, k, m, size, GF28Region::kernelName(kernel), 1,
+            [&](const unsigned char * const *data, unsigned char * const *parity) {
+                rs.encodeStripe(data, parity, m, size);
+            }, [&](const Shard *shards, unsigned char * const *out) {
+                rs.decode(shards, k, out, size);
+            }, first);
+}
+
+/* The same measurements with the XOR only bit-matrix code */
+static bool runXorConfig(const Options &opt, unsigned int k, unsigned int m,
+        size_t size, bool &first) {
+    RSxorCode rs(k, m);
+    return runCode(opt, k, m, size, "xor", 1,
+            [&](const unsigned char * const *data, unsigned char * const *parity) {
+                rs.encode(data, parity, size);
+            }, [&](const Shard *shards, unsigned char * const *out) {
+                rs.decode(shards, k, out, size);
+            }, first);
+}
+
+template<typename V>
+static bool parseList(const char *arg, vector<V> &list) {
+    list.clear();
+    stringstream ss(arg);
+    string item;
+    while (getline(ss, item, ',')) {
+        char *end;
+        unsigned long long v = strtoull(item.c_str(), &end, 0);
+        if (*end == 'K' || *end == 'k') {
+            v <<= 10;
+        } else if (*end == 'M') {
+            v <<= 20;
+        } else if (*end != '\0') {
+            return false;
+        }
+        list.push_back((V) v);
+    }
+    return !list.empty();
+}
+
+static void usage(void) {
+    cerr << "usage: RScodeBench [options]" << endl;
+    cerr << "  -k list      data shards (default 4,10)" << endl;
+    cerr << "  -m list      FEC shards (default 2,4)" << endl;
+    cerr << "  -s list      shard sizes, K/M suffix allowed (default 4K,64K,1M,16M)" << endl;
+    cerr << "  -e list      erasures to decode, 0 = m (default 1,0)" << endl;
+    cerr << "  -t list      threads (default 1)" << endl;
+    cerr << "  -K list|all  kernels: scalar,ssse3,avx2,avx2-gfni,avx512,avx512-gfni,xor (default best)" << endl;
+    cerr << "               xor is the XOR only bit-matrix code, single threaded, shard sizes multiple of 8" << endl;
+    cerr << "  -T bytes     columns of a tile, 0 = from the L2 cache size (default 0)" << endl;
+    cerr << "  -w n         warm-up iterations (default 3)" << endl;
+    cerr << "  -r min,max   repetitions (default 10,10000)" << endl;
+    cerr << "  -b bytes     data bytes timed per configuration (default 256M)" << endl;
+    cerr << "  -f format    text, csv or json (default text)" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    Options opt;
+    parseList("4,10", opt.m_k);
+    parseList("2,4", opt.m_m);
+    parseList("4K,64K,1M,16M", opt.m_size);
+    parseList("1,0", opt.m_erasures);
+    parseList("1", opt.m_threads);
+    opt.m_kernels.push_back(GF28Region::kernel());
+    opt.m_xor = false;
+    opt.m_tileSize = 0;
+    opt.m_warmup = 3;
+    opt.m_minReps = 10;
+    opt.m_maxReps = 10000;
+    opt.m_bytesPerConfig = 256 << 20;
+    opt.m_format = e_format_text;
+
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        const char *arg = argv[++i];
+        bool ok = true;
+        vector<size_t> v;
+        switch (argv[i - 1][1]) {
+        case 'k':
+            ok = parseList(arg, opt.m_k);
+            break;
+        case 'm':
+            ok = parseList(arg, opt.m_m);
+            break;
+        case 's':
+            ok = parseList(arg, opt.m_size);
+            break;
+        case 'e':
+            ok = parseList(arg, opt.m_erasures);
+            break;
+        case 't':
+            ok = parseList(arg, opt.m_threads);
+            break;
+        case 'K': {
+            opt.m_kernels.clear();
+            string list = string(",") + arg + ",";
+            for (int n = 0; n < GF28Region::e_gf28_kernel_max; ++n) {
+                GF28Region::E_GF28_KERNEL kernel = (GF28Region::E_GF28_KERNEL) n;
+                string name = string(",") + GF28Region::kernelName(kernel) + ",";
+                if ((list == ",all," || list.find(name) != string::npos)
+                        && GF28Region::isSupported(kernel)) {
+                    opt.m_kernels.push_back(kernel);
+                }
+            }
+            opt.m_xor = list == ",all," || list.find(",xor,") != string::npos;
+            ok = !opt.m_kernels.empty() || opt.m_xor;
+            break;
+        }
+        case 'T':
+            ok = parseList(arg, v) && v.size() == 1;
+            if (ok) {
+                opt.m_tileSize = v[0];
+            }
+            break;
+        case 'w':
+            opt.m_warmup = strtoul(arg, NULL, 0);
+            break;
+        case 'r':
+            ok = parseList(arg, v) && v.size() == 2 && v[0] > 0 && v[0] <= v[1];
+            if (ok) {
+                opt.m_minReps = v[0];
+                opt.m_maxReps = v[1];
+            }
+            break;
+        case 'b':
+            ok = parseList(arg, v) && v.size() == 1;
+            if (ok) {
+                opt.m_bytesPerConfig = v[0];
+            }
+            break;
+        case 'f':
+            opt.m_format = (strcmp(arg, "csv") == 0) ? e_format_csv :
+                    (strcmp(arg, "json") == 0) ? e_format_json : e_format_text;
+            ok = opt.m_format != e_format_text || strcmp(arg, "text") == 0;
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            usage();
+            return 2;
+        }
+    }
+
+    bool first = true;
+    bool res = true;
+    for (size_t n = 0; n < opt.m_kernels.size(); ++n) {
+        GF28Region::setKernel(opt.m_kernels[n]);
+        for (size_t t = 0; t < opt.m_threads.size(); ++t) {
+            for (size_t a = 0; a < opt.m_k.size(); ++a) {
+                for (size_t b = 0; b < opt.m_m.size(); ++b) {
+                    if (opt.m_k[a] + opt.m_m[b] > GF28Value::limit()) {
+                        continue;
+                    }
+                    for (size_t s = 0; s < opt.m_size.size(); ++s) {
+                        res = runConfig(opt, opt.m_k[a], opt.m_m[b], opt.m_size[s],
+                                opt.m_threads[t], opt.m_kernels[n], first) && res;
+                    }
+                }
+            }
+        }
+    }
+    for (size_t a = 0; a < opt.m_k.size() && opt.m_xor; ++a) {
+        for (size_t b = 0; b < opt.m_m.size(); ++b) {
+            if (opt.m_k[a] + opt.m_m[b] > GF28Value::limit()) {
+                continue;
+            }
+            for (size_t s = 0; s < opt.m_size.size(); ++s) {
+                if (opt.m_size[s] % RSxorCode::W == 0) {
+                    res = runXorConfig(opt, opt.m_k[a], opt.m_m[b], opt.m_size[s],
+                            first) && res;
+                }
+            }
+        }
+    }
+    if (opt.m_format == e_format_json) {
+        cout << (first ? "[]" : "\n]") << endl;
+    }
+    return res ? 0 : 1;
+}
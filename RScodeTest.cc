@@ -7,13 +7,35 @@
 
 #include <iostream>
 #include <algorithm>    /* for_each */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <new>
+#include <atomic>
+#include <thread>
+#include <unistd.h>
 
 #include "GF28Value.hh"
+#include "GF28Region.hh"
+#include "GF2wValue.hh"
 #include "RScode.hh"
+#include "RSengine.hh"
+#include "RSqueue.hh"
+#include "RSstats.hh"
+#include "Crc32c.hh"
+#include "RSxorCode.hh"
+#include "RSlrcCode.hh"
+#include "RSfile.hh"
+#include "RSdecoder.hh"
 
 using namespace std;
 
 
+/* Heap allocations of the test (RScodeTestAlloc.cc), to check the hot
+ * paths make none */
+extern std::atomic<unsigned long long> g_allocations;
+
 /* Test */
 const static unsigned int DATA_SIZE = 32;
 const static unsigned int ENCODE_SIZE = 256;
@@ -38,10 +60,9 @@ static bool verifyData(unsigned char *encode, unsigned char *decode,
  * then select any n rows data from original data, FEC data or both,
  * recover data using them and verify if the result equals to the original data.
  */
-static void _doTest(unsigned int *lines, bool showResult) {
+static bool _doTest(unsigned int *lines, bool showResult) {
     unsigned char data[DATA_SIZE][DATA_SIZE] = { { 0 } };       /* original data */
     unsigned char encode[ENCODE_SIZE][DATA_SIZE] = { { 0 } };   /* encoded data */
-    unsigned char decode[DATA_SIZE][DATA_SIZE] = { { 0 } };     /* data which to be decode */
     unsigned char recover[DATA_SIZE][DATA_SIZE] = { { 0 } };    /* should be equal with original data */
 
     /* Setup output format and create test data with random data */
@@ -73,27 +94,34 @@ static void _doTest(unsigned int *lines, bool showResult) {
     /* Encode original data to (DATA_SIZE x ENCODE_SIZE) byte.
      * creating additional ((ENCODE_SIZE - DATA_SIZE) x DATA_SIZE) byte FEC data
      * */
-    for (unsigned int i = 0; i < ENCODE_SIZE; ++i) {
-        rs.encodeLine((unsigned char *) data, DATA_SIZE, encode[i]);
+    const unsigned char *pData[DATA_SIZE];
+    unsigned char *pParity[ENCODE_SIZE - DATA_SIZE];
+    for (unsigned int i = 0; i < DATA_SIZE; ++i) {
+        memcpy(encode[i], data[i], DATA_SIZE);
+        pData[i] = data[i];
+    }
+    for (unsigned int i = DATA_SIZE; i < ENCODE_SIZE; ++i) {
+        pParity[i - DATA_SIZE] = encode[i];
     }
+    rs.encodeStripe(pData, pParity, ENCODE_SIZE - DATA_SIZE, DATA_SIZE);
 
-    /* Select any DATA_SIZE rows from encoded data to recover original data
-     * and swap rows putting identity rows in their proper places */
+    /* Select any DATA_SIZE rows (in any order) from encoded data to recover original data */
+    RScode<GF28Value>::Shard shards[DATA_SIZE];
+    unsigned char *pRecover[DATA_SIZE];
     for (unsigned int i = 0; i < DATA_SIZE; ++i) {
-        if (lines[i] < DATA_SIZE && lines[i] != i) {
-            unsigned int index = lines[i];
-            lines[i] = lines[index];
-            lines[index] = index;
-        }
+        shards[i].index = lines[i];
+        shards[i].data = encode[lines[i]];
+        pRecover[i] = recover[i];
     }
+
+    /* Recover missing data using selected rows, present rows are not written */
+    rs.decode(shards, DATA_SIZE, pRecover, DATA_SIZE);
     for (unsigned int i = 0; i < DATA_SIZE; ++i) {
-        memcpy(decode[i], &encode[lines[i]], DATA_SIZE);
+        if (lines[i] < DATA_SIZE) {
+            memcpy(recover[lines[i]], encode[lines[i]], DATA_SIZE);
+        }
     }
 
-    /* Recover original data using selected rows */
-    rs.decode((unsigned char *) decode, lines, (unsigned char *) recover,
-            DATA_SIZE);
-
     /* Debug info */
     w = cout.width();
     cout.width(2);
@@ -124,10 +152,12 @@ static void _doTest(unsigned int *lines, bool showResult) {
     }
 
     rs.clear();
+    return res;
 }
 
 #include <set>
-static void testAll(void) {
+static bool testAll(void) {
+    bool res = true;
     srand(time(NULL));
     unsigned int indexArray[DATA_SIZE] = { 0 };
 
@@ -136,14 +166,14 @@ static void testAll(void) {
     for (unsigned int i = 0; i < DATA_SIZE; ++i) {
         indexArray[i] = i;
     }
-    _doTest(indexArray, true);
+    res = _doTest(indexArray, true) && res;
 
     /* all missing */
     cout << "Test all missing:" << endl;
     for (unsigned int i = 0; i < DATA_SIZE; ++i) {
         indexArray[i] = i + DATA_SIZE;
     }
-    _doTest(indexArray, true);
+    res = _doTest(indexArray, true) && res;
 
     /* half missing */
     cout << "Test half missing:" << endl;
@@ -154,7 +184,7 @@ static void testAll(void) {
             indexArray[i] = i;
         }
     }
-    _doTest(indexArray, true);
+    res = _doTest(indexArray, true) && res;
     //rs.debug();
 
     /* random rows */
@@ -169,17 +199,1566 @@ static void testAll(void) {
             }
             r.insert(v);
         }
-        _doTest(indexArray, false);
+        /* rows in random order */
+        std::copy(r.begin(), r.end(), indexArray);
+        for (unsigned int i = DATA_SIZE - 1; i > 0; --i) {
+            std::swap(indexArray[i], indexArray[rand() % (i + 1)]);
+        }
+        res = _doTest(indexArray, false) && res;
         if (count % (maxTimes / 10) == 0) {
             cout << count << " test passed..." << endl;
         }
     }
     cout << "done." << endl;
+    return res;
+}
+
+/* Bitwise multiplication in GF(2^w) modulo poly, by default
+ * x^8 + x^4 + x^3 + x^2 + 1 */
+static unsigned int slowMultiply(unsigned int a, unsigned int b,
+        unsigned int w = 8, unsigned int poly = 0x11D) {
+    unsigned int r = 0;
+    for (; b != 0; b >>= 1) {
+        if (b & 1) {
+            r ^= a;
+        }
+        a <<= 1;
+        if (a & (1u << w)) {
+            a ^= poly;
+        }
+    }
+    return r;
+}
+
+/* Compare the table driven field operations with bitwise multiplication */
+static bool testField(void) {
+    bool res = true;
+
+    cout << "Test field operations:" << endl;
+    for (unsigned int a = 0; a < 256; ++a) {
+        unsigned int p = 1;
+        for (unsigned int b = 0; b < 256; ++b) {
+            unsigned int r = slowMultiply(a, b);
+            res = res && (GF28Value(a) * GF28Value(b)).value() == r;
+            if (b != 0) {
+                res = res && (GF28Value(r) / GF28Value(b)).value() == a;
+            }
+            res = res && (GF28Value(a) ^ GF28Value(b)).value() == p;
+            p = slowMultiply(p, a);
+        }
+        if (a != 0) {
+            res = res && slowMultiply(GF28Value(a).inverse().value(), a) == 1;
+        }
+    }
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Compare every region kernel the CPU supports with GF28Value multiplication,
+ * using lengths which are not multiple of the vector width */
+static bool testRegion(void) {
+    const unsigned int SIZE = 301;
+    unsigned char src[SIZE];
+    unsigned char dst[SIZE];
+    unsigned char expect[SIZE];
+    GF28Region::E_GF28_KERNEL best = GF28Region::kernel();
+    bool res = true;
+
+    cout << "Test region kernels:" << endl;
+    for (unsigned int i = 0; i < SIZE; ++i) {
+        src[i] = rand() % 256;
+    }
+    for (int k = 0; k < GF28Region::e_gf28_kernel_max; ++k) {
+        GF28Region::E_GF28_KERNEL kernel = (GF28Region::E_GF28_KERNEL) k;
+        if (!GF28Region::setKernel(kernel)) {
+            cout << GF28Region::kernelName(kernel) << " not supported." << endl;
+            continue;
+        }
+        bool ok = true;
+        for (unsigned int c = 0; c < 256 && ok; ++c) {
+            unsigned int len = SIZE - c % 64;
+            for (unsigned int i = 0; i < len; ++i) {
+                expect[i] = (GF28Value(c) * GF28Value(src[i])).value();
+                dst[i] = ~expect[i];
+            }
+            GF28Region::multiply(dst, src, c, len);
+            ok = ok && memcmp(dst, expect, len) == 0;
+            for (unsigned int i = 0; i < len; ++i) {
+                dst[i] = i;
+                expect[i] ^= i;
+            }
+            GF28Region::multiplyAdd(dst, src, c, len);
+            ok = ok && memcmp(dst, expect, len) == 0;
+        }
+        /* dotProduct of 5 rows starting at src + 3 */
+        const unsigned char *rows[5] = { src, src + 11, src + 23, src + 37, src + 41 };
+        unsigned char coeff[5];
+        for (unsigned int n = 0; n < 5; ++n) {
+            coeff[n] = rand() % 256;
+        }
+        for (unsigned int i = 0; i < SIZE - 48; ++i) {
+            GF28Value v(0);
+            for (unsigned int n = 0; n < 5; ++n) {
+                v = v + GF28Value(coeff[n]) * GF28Value(rows[n][3 + i]);
+            }
+            expect[i] = v.value();
+        }
+        GF28Region::dotProduct(dst, rows, 3, coeff, 5, SIZE - 48);
+        ok = ok && memcmp(dst, expect, SIZE - 48) == 0;
+        cout << GF28Region::kernelName(kernel) << (ok ? " ok." : " error.") << endl;
+        res = res && ok;
+    }
+    GF28Region::setKernel(best);
+    cout << "selected kernel: " << GF28Region::kernelName(best) << endl;
+    return res;
+}
+
+/* encodeStripe must create the same FEC lines as encodeLine, whatever
+ * the tile size */
+static bool testEncodeStripe(void) {
+    const unsigned int K = 10;
+    const unsigned int M = 4;
+    const unsigned int SIZE = 20000 + 13;
+    RScode<GF28Value> rs(K, SIZE);
+    unsigned char *data = new unsigned char[K * SIZE];
+    unsigned char *expect = new unsigned char[SIZE];
+    unsigned char *parity[M];
+    const unsigned char *pData[K];
+    bool res = true;
+
+    cout << "Test encodeStripe:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        data[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = data + i * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        parity[i] = new unsigned char[SIZE];
+    }
+    const size_t tiles[] = { 0, 1, 3000 };
+    for (unsigned int t = 0; t < sizeof(tiles) / sizeof(tiles[0]); ++t) {
+        rs.setTileSize(tiles[t]);
+        rs.clear();
+        rs.encodeStripe(pData, parity, M, SIZE);
+        for (unsigned int i = 0; i < K + M; ++i) {
+            rs.encodeLine(data, SIZE, expect);
+            if (i >= K && memcmp(expect, parity[i - K], SIZE) != 0) {
+                cout << "FEC line " << i << " (tile " << rs.tileSize()
+                        << ") error." << endl;
+                res = false;
+            }
+        }
+    }
+    if (rs.encodeStripe(pData, parity, 256 - K + 1, SIZE) != RScode<GF28Value>::e_rscode_sts_limit_err) {
+        res = false;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        delete[] parity[i];
+    }
+    delete[] data;
+    delete[] expect;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* FEC rows created on first use (also by threads racing to grow them)
+ * must match the Cauchy rows 1/(x+y) and a codec configured with them */
+static bool testLazyMatrix(void) {
+    const unsigned int K = 7;
+    const unsigned int M = 40;
+    const unsigned int SIZE = 512;
+    const unsigned int THREADS = 4;
+    const RScode<GF28Value> rs(K, SIZE);
+    const RScode<GF28Value> fixed(K, SIZE, K + 3);
+    std::vector<unsigned char> data(K * SIZE);
+    std::vector<unsigned char> parity(THREADS * M * SIZE);
+    const unsigned char *pData[K];
+    std::atomic<bool> ok(true);
+    bool res = rs.error() == RScode<GF28Value>::e_rscode_sts_ok
+            && fixed.error() == RScode<GF28Value>::e_rscode_sts_ok;
+
+    cout << "Test lazy matrix:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        data[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = &data[i * SIZE];
+    }
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.push_back(std::thread([&, t] {
+            unsigned char *pParity[M];
+            for (unsigned int j = 0; j < M; ++j) {
+                pParity[j] = &parity[(t * M + j) * SIZE];
+            }
+            for (unsigned int m = 1 + t; m <= M; m += THREADS) {
+                if (rs.encodeStripe(pData, pParity, m, SIZE) != RScode<GF28Value>::e_rscode_sts_ok) {
+                    ok = false;
+                }
+            }
+        }));
+    }
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads[t].join();
+    }
+    res = res && ok;
+    /* the last pass of every thread encoded M - THREADS + 1 + t rows */
+    for (unsigned int t = 0; t < THREADS && res; ++t) {
+        for (unsigned int j = 0; j < M - THREADS + 1 + t && res; ++j) {
+            for (unsigned int b = 0; b < SIZE && res; ++b) {
+                GF28Value y(0);
+                for (unsigned int i = 0; i < K; ++i) {
+                    y = y + GF28Value(1) / (GF28Value(K + j) + GF28Value(i))
+                            * GF28Value(data[i * SIZE + b]);
+                }
+                res = y.value() == parity[(t * M + j) * SIZE + b];
+            }
+        }
+    }
+    unsigned char *pParity[3];
+    std::vector<unsigned char> expect(3 * SIZE);
+    for (unsigned int j = 0; j < 3; ++j) {
+        pParity[j] = &expect[j * SIZE];
+    }
+    res = res && fixed.encodeStripe(pData, pParity, 3, SIZE) == RScode<GF28Value>::e_rscode_sts_ok
+            && memcmp(&expect[0], &parity[0], 3 * SIZE) == 0;
+    res = res && fixed.encodeStripe(pData, pParity, 4, SIZE) == RScode<GF28Value>::e_rscode_sts_limit_err;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Decoding the same pattern again must take the rows kept in the Context,
+ * another pattern or Context must go to the shared cache */
+static bool testDecodeCache(void) {
+    const unsigned int K = 4;
+    const unsigned int SIZE = 1000;
+    RScode<GF28Value> rs(K, SIZE);
+    unsigned char data[K][SIZE];
+    unsigned char encode[K + 2][SIZE];
+    unsigned char decode[K][SIZE];
+    unsigned char recover[K][SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[2] = { encode[K], encode[K + 1] };
+    unsigned int lines[2][K] = { { 0, 4, 2, 3 }, { 5, 1, 4, 3 } };
+    bool res = true;
+
+    cout << "Test decode cache:" << endl;
+    for (unsigned int i = 0; i < K; ++i) {
+        for (unsigned int j = 0; j < SIZE; ++j) {
+            data[i][j] = rand() % 256;
+        }
+        memcpy(encode[i], data[i], SIZE);
+        pData[i] = data[i];
+    }
+    rs.encodeStripe(pData, pParity, 2, SIZE);
+    rs.setDecodeCacheSize(1);
+    for (unsigned int n = 0; n < 5; ++n) {
+        unsigned int *index = lines[n / 2 % 2];
+        for (unsigned int i = 0; i < K; ++i) {
+            memcpy(decode[i], encode[index[i]], SIZE);
+        }
+        memset(recover, 0, sizeof(recover));
+        rs.decode((unsigned char *) decode, index, (unsigned char *) recover, SIZE);
+        res = verifyData((unsigned char *) data, (unsigned char *) recover, K, SIZE) && res;
+    }
+    /* patterns: a a b b a, the repeats are served by the Context and the
+     * shared cache holds one matrix */
+    if (rs.decodeCacheHits() != 0 || rs.decodeCacheMisses() != 3) {
+        cout << "hits " << rs.decodeCacheHits() << " misses " << rs.decodeCacheMisses() << endl;
+        res = false;
+    }
+    /* another Context finds a in the shared cache once, then keeps it */
+    RScode<GF28Value>::Context ctx;
+    for (unsigned int n = 0; n < 2; ++n) {
+        memset(recover, 0, sizeof(recover));
+        res = rs.decode((unsigned char *) decode, lines[0], (unsigned char *) recover,
+                SIZE, ctx) == RScode<GF28Value>::e_rscode_sts_ok && res;
+        res = verifyData((unsigned char *) data, (unsigned char *) recover, K, SIZE) && res;
+    }
+    if (rs.decodeCacheHits() != 1 || rs.decodeCacheMisses() != 3) {
+        cout << "hits " << rs.decodeCacheHits() << " misses " << rs.decodeCacheMisses() << endl;
+        res = false;
+    }
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Parity updated with updateParity must equal the parity of the new data */
+static bool testUpdateParity(void) {
+    const unsigned int K = 6;
+    const unsigned int M = 3;
+    const unsigned int SIZE = 20000;
+    RScode<GF28Value> rs(K, SIZE);
+    unsigned char *buf = new unsigned char[(K + M * 2 + 1) * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned char *pExpect[M];
+    unsigned char *old = buf + (K + M * 2) * SIZE;
+    bool res = true;
+
+    cout << "Test update parity:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+        pExpect[i] = buf + (K + M + i) * SIZE;
+    }
+    rs.encodeStripe(pData, pParity, M, SIZE);
+    /* overwrite columns [1001, 11001) of line 3 with old and new data */
+    unsigned char *line = buf + 3 * SIZE;
+    memcpy(old, line + 1001, 10000);
+    for (unsigned int i = 1001; i < 11001; ++i) {
+        line[i] = rand() % 256;
+    }
+    res = rs.updateParity(3, old, line + 1001, pParity, M, 1001, 10000) == 0 && res;
+    /* overwrite columns [17, 18) of line 0 with a delta */
+    unsigned char delta = rand() % 255 + 1;
+    buf[17] ^= delta;
+    res = rs.updateParity(0, &delta, pParity, M, 17, 1) == 0 && res;
+    rs.encodeStripe(pData, pExpect, M, SIZE);
+    for (unsigned int i = 0; i < M; ++i) {
+        res = verifyData(pExpect[i], pParity[i], 1, SIZE) && res;
+    }
+    res = rs.updateParity(K, &delta, pParity, M, 0, 1) != 0 && res;
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* A moved codec keeps working, and once the decoding rows are cached,
+ * encoding and decoding with a Context make no heap allocation */
+static bool testWorkspace(void) {
+    const unsigned int K = 8;
+    const unsigned int M = 3;
+    const unsigned int SIZE = 4096;
+    RScode<GF28Value> tmp(K, SIZE, 0, true);
+    RScode<GF28Value> rs(std::move(tmp));
+    RScode<GF28Value>::Context ws;
+    unsigned char *buf = new unsigned char[(K + M + K) * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned char *pRecover[K];
+    RScode<GF28Value>::Shard shards[K];
+    bool res = tmp.error() == RScode<GF28Value>::e_rscode_sts_init
+            && rs.error() == RScode<GF28Value>::e_rscode_sts_ok;
+
+    cout << "Test workspace:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+        pRecover[i] = buf + (K + M + i) * SIZE;
+        shards[i].index = (i < M) ? K + i : i;
+        shards[i].data = buf + shards[i].index * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+    }
+    rs.encodeStripe(pData, pParity, M, SIZE);
+    res = rs.decode(shards, K, pRecover, SIZE, ws) == 0 && res;
+    unsigned long long before = g_allocations.load();
+    for (unsigned int n = 0; n < 10; ++n) {
+        rs.encodeStripe(pData, pParity, M, SIZE);
+        res = rs.decode(shards, K, pRecover, SIZE, ws) == 0 && res;
+    }
+    unsigned long long allocations = g_allocations.load() - before;
+    if (allocations != 0) {
+        cout << allocations << " allocations." << endl;
+        res = false;
+    }
+    res = verifyData(buf, pRecover[0], M, SIZE) && res;
+    res = tmp.encodeStripe(pData, pParity, M, SIZE) != 0 && res;
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* One const codec shared by threads, each decoding its own erasure
+ * pattern and encoding lines with its own Context */
+static bool testSharedCodec(void) {
+    const unsigned int K = 6;
+    const unsigned int M = 3;
+    const unsigned int SIZE = 1000;
+    const unsigned int THREADS = 4;
+    const RScode<GF28Value> rs(K, SIZE);
+    unsigned char *buf = new unsigned char[(K + M) * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    std::atomic<bool> ok(true);
+
+    cout << "Test shared codec:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+    }
+    bool res = rs.encodeStripe(pData, pParity, M, SIZE)
+            == RScode<GF28Value>::e_rscode_sts_ok;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            RScode<GF28Value>::Context ctx;
+            RScode<GF28Value>::Shard shards[K];
+            std::vector<unsigned char> recover(K * SIZE);
+            std::vector<unsigned char> line(SIZE);
+            unsigned char *pRecover[K];
+            for (unsigned int i = 0; i < K; ++i) {
+                pRecover[i] = &recover[i * SIZE];
+            }
+            for (unsigned int n = 0; n < 100; ++n) {
+                /* lines t and (t + n) % K are lost */
+                unsigned int lost[2] = { t, (t + n) % K };
+                unsigned int count = 0;
+                for (unsigned int i = 0; i < K + M && count < K; ++i) {
+                    if (i != lost[0] && i != lost[1]) {
+                        shards[count].index = i;
+                        shards[count++].data = buf + i * SIZE;
+                    }
+                }
+                if (rs.decode(shards, K, pRecover, SIZE, ctx)
+                        != RScode<GF28Value>::e_rscode_sts_ok
+                        || memcmp(pRecover[lost[0]], pData[lost[0]], SIZE) != 0
+                        || memcmp(pRecover[lost[1]], pData[lost[1]], SIZE) != 0) {
+                    ok = false;
+                }
+            }
+            /* the cursor belongs to the context */
+            for (unsigned int i = 0; i < K + M; ++i) {
+                if (rs.encodeLine(buf, SIZE, line.data(), ctx)
+                        != RScode<GF28Value>::e_rscode_sts_ok
+                        || memcmp(line.data(), buf + i * SIZE, SIZE) != 0) {
+                    ok = false;
+                }
+            }
+            /* errors are returned, not printed */
+            if (rs.decode(shards, K - 1, pRecover, SIZE, ctx)
+                    != RScode<GF28Value>::e_rscode_sts_shards_err
+                    || ctx.error() != RScode<GF28Value>::e_rscode_sts_shards_err) {
+                ok = false;
+            }
+        }));
+    }
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads[t].join();
+    }
+    res = ok && res;
+    res = rs.error() == RScode<GF28Value>::e_rscode_sts_ok && res;
+    res = rs.encodeStripe(pData, pParity, M + 256, SIZE)
+            == RScode<GF28Value>::e_rscode_sts_limit_err && res;
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* reconstruct must write the missing lines only */
+static bool testReconstruct(void) {
+    const unsigned int K = 10;
+    const unsigned int M = 4;
+    const unsigned int SIZE = 4099;
+    RScode<GF28Value> rs(K, SIZE);
+    unsigned char *encode = new unsigned char[(K + M) * SIZE];
+    unsigned char *decode = new unsigned char[K * SIZE];
+    unsigned char *recover = new unsigned char[K * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned int lines[3][K] = {
+            { 0, 1, 2, 3, 4, 5, 6, 12, 8, 9 },
+            { 11, 1, 2, 13, 4, 10, 6, 7, 12, 9 },
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 } };
+    bool res = true;
+
+    cout << "Test reconstruct:" << endl;
+    for (unsigned int i = 0; i < K * SIZE; ++i) {
+        encode[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = encode + i * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = encode + (K + i) * SIZE;
+    }
+    rs.encodeStripe(pData, pParity, M, SIZE);
+    for (unsigned int n = 0; n < 3; ++n) {
+        for (unsigned int i = 0; i < K; ++i) {
+            memcpy(decode + i * SIZE, encode + lines[n][i] * SIZE, SIZE);
+        }
+        memset(recover, 0xaa, K * SIZE);
+        if (rs.reconstruct(decode, lines[n], recover, SIZE) != 0) {
+            res = false;
+        }
+        for (unsigned int i = 0; i < K; ++i) {
+            if (lines[n][i] != i) {
+                res = verifyData(encode + i * SIZE, recover + i * SIZE, 1, SIZE) && res;
+            } else {
+                for (unsigned int j = 0; j < SIZE; ++j) {
+                    if (recover[i * SIZE + j] != 0xaa) {
+                        cout << "present line " << i << " was written." << endl;
+                        res = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    delete[] encode;
+    delete[] decode;
+    delete[] recover;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* A batch of stripes losing the same shards is decoded with one lookup
+ * of the decoding rows, by RScode and by RSengine */
+static bool testDecodeStripes(void) {
+    const unsigned int K = 6;
+    const unsigned int M = 3;
+    const unsigned int STRIPES = 40;
+    const unsigned int SIZE = 300;
+    RScode<GF28Value> rs(K, SIZE);
+    RSengine<GF28Value> engine(rs, 4, 64);
+    std::vector<unsigned char> buf(STRIPES * (K + M) * SIZE);
+    std::vector<unsigned char> recover(STRIPES * K * SIZE);
+    std::vector<const unsigned char*> pShards(STRIPES * K);
+    const unsigned char * const *shards[STRIPES];
+    unsigned char *pRecover[STRIPES][K];
+    unsigned char * const *data[STRIPES];
+    /* lines 1 and 4 are lost, the shards are given in any order */
+    const unsigned int indices[K] = { 8, 0, 5, 7, 3, 2 };
+    bool res = true;
+
+    cout << "Test decode stripes:" << endl;
+    for (unsigned int s = 0; s < STRIPES; ++s) {
+        unsigned char *stripe = &buf[s * (K + M) * SIZE];
+        const unsigned char *pData[K];
+        unsigned char *pParity[M];
+        for (unsigned int i = 0; i < K * SIZE; ++i) {
+            stripe[i] = rand() % 256;
+        }
+        for (unsigned int i = 0; i < K; ++i) {
+            pData[i] = stripe + i * SIZE;
+            pShards[s * K + i] = stripe + indices[i] * SIZE;
+            pRecover[s][i] = (i == 1 || i == 4) ? &recover[(s * K + i) * SIZE] : NULL;
+        }
+        for (unsigned int i = 0; i < M; ++i) {
+            pParity[i] = stripe + (K + i) * SIZE;
+        }
+        rs.encodeStripe(pData, pParity, M, SIZE);
+        shards[s] = &pShards[s * K];
+        data[s] = pRecover[s];
+    }
+    unsigned long long lookups = rs.decodeCacheHits() + rs.decodeCacheMisses();
+    res = rs.decodeStripes(indices, K, shards, data, STRIPES, SIZE) == 0 && res;
+    res = rs.decodeCacheHits() + rs.decodeCacheMisses() == lookups + 1 && res;
+    for (unsigned int n = 0; n < 2; ++n) {
+        for (unsigned int s = 0; s < STRIPES; ++s) {
+            const unsigned char *stripe = &buf[s * (K + M) * SIZE];
+            res = memcmp(pRecover[s][1], stripe + SIZE, SIZE) == 0
+                    && memcmp(pRecover[s][4], stripe + 4 * SIZE, SIZE) == 0 && res;
+        }
+        memset(recover.data(), 0, recover.size());
+        if (n == 0) {
+            res = engine.decodeStripes(indices, K, shards, data, STRIPES, SIZE)
+                    == RScode<GF28Value>::e_rscode_sts_ok && res;
+        }
+    }
+    /* a missing output and too few shards are reported */
+    pRecover[STRIPES - 1][4] = NULL;
+    res = engine.decodeStripes(indices, K, shards, data, STRIPES, SIZE)
+            == RScode<GF28Value>::e_rscode_sts_output_err && res;
+    res = rs.decodeStripes(indices, K - 1, shards, data, STRIPES, SIZE) != 0 && res;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* A byte range of a lost line must decode from the same range of the
+ * survivors only: the other columns of the shards are zeroed */
+static bool testDecodeRange(void) {
+    const unsigned int K = 8;
+    const unsigned int M = 3;
+    const size_t SIZE = 1 << 16;
+    RScode<GF28Value> rs(K, 1);
+    RScode<GF28Value>::Context ctx;
+    std::vector<unsigned char> buf((K + M) * SIZE);
+    std::vector<unsigned char> part((K + M) * SIZE);
+    std::vector<unsigned char> out(SIZE);
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    RScode<GF28Value>::Shard shards[K];
+    /* lines 2, 5 and 6 are lost */
+    const unsigned int rows[K] = { 9, 0, 1, 3, 4, 8, 7, 10 };
+    const size_t ranges[][2] = { { 0, 4096 }, { 12345, 1 }, { SIZE - 700, 700 },
+            { 4000, 40000 }, { 0, SIZE } };
+    bool res = true;
+
+    cout << "Test decode range:" << endl;
+    for (size_t i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = &buf[i * SIZE];
+        shards[i].index = rows[i];
+        shards[i].data = &part[rows[i] * SIZE];
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = &buf[(K + i) * SIZE];
+    }
+    res = rs.encodeStripe(pData, pParity, M, SIZE) == 0;
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]) && res; ++r) {
+        const size_t offset = ranges[r][0];
+        const size_t length = ranges[r][1];
+        memset(part.data(), 0, part.size());
+        for (unsigned int i = 0; i < K; ++i) {
+            memcpy(&part[rows[i] * SIZE + offset], &buf[rows[i] * SIZE + offset], length);
+        }
+        for (unsigned int line = 0; line < K && res; ++line) {
+            memset(out.data(), 0, length);
+            res = rs.decodeRange(shards, K, line, out.data(), offset, length, ctx)
+                    == RScode<GF28Value>::e_rscode_sts_ok;
+            res = res && memcmp(out.data(), &buf[line * SIZE + offset], length) == 0;
+        }
+    }
+    /* errors */
+    res = res && rs.decodeRange(shards, K, K, out.data(), 0, 1, ctx)
+            == RScode<GF28Value>::e_rscode_sts_index_err;
+    res = res && rs.decodeRange(shards, K - 1, 2, out.data(), 0, 1, ctx)
+            == RScode<GF28Value>::e_rscode_sts_shards_err;
+    res = res && rs.decodeRange(shards, K, 2, out.data(), 0, 0, ctx)
+            == RScode<GF28Value>::e_rscode_sts_size_err;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* CRC-32C check value, hardware and table versions must agree, and the
+ * checksums of the fused encode and decode must match separate ones */
+static bool testCrc(void) {
+    const unsigned int K = 5;
+    const unsigned int M = 3;
+    const size_t SIZE = 10000;
+    RScode<GF28Value> rs(K, 1);
+    RScode<GF28Value>::Context ctx;
+    std::vector<unsigned char> buf((K + M) * SIZE);
+    std::vector<unsigned char> recover(K * SIZE);
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned char *pRecover[K];
+    uint32_t crc[K + M];
+    uint32_t dataCrc[K];
+    bool res = Crc32c::extend(0, (const unsigned char *) "123456789", 9) == 0xE3069283;
+
+    cout << "Test crc32c(" << (Crc32c::hardware() ? "sse4.2" : "table") << "):" << endl;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (size_t len = 0; len < 100 && res; ++len) {
+        res = Crc32c::extend(7, &buf[len], len) == Crc32c::extendTable(7, &buf[len], len);
+        res = res && Crc32c::extend(Crc32c::extend(0, &buf[0], len), &buf[len], 100)
+                == Crc32c::extend(0, &buf[0], len + 100);
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = &buf[i * SIZE];
+        pRecover[i] = &recover[i * SIZE];
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = &buf[(K + i) * SIZE];
+    }
+    /* tiles which do not divide the shards */
+    rs.setTileSize(3000);
+    res = res && rs.encodeStripeCrc(pData, pParity, M, SIZE, crc) == RScode<GF28Value>::e_rscode_sts_ok;
+    for (unsigned int i = 0; i < K + M && res; ++i) {
+        res = crc[i] == Crc32c::extend(0, &buf[i * SIZE], SIZE);
+    }
+    /* lines 0 and 3 are lost */
+    RScode<GF28Value>::Shard shards[K];
+    const unsigned int rows[K] = { 6, 1, 2, 5, 4 };
+    for (unsigned int i = 0; i < K; ++i) {
+        shards[i].index = rows[i];
+        shards[i].data = &buf[rows[i] * SIZE];
+    }
+    res = res && rs.decodeCrc(shards, K, pRecover, SIZE, dataCrc, ctx) == RScode<GF28Value>::e_rscode_sts_ok;
+    for (unsigned int i = 0; i < K && res; ++i) {
+        res = dataCrc[i] == crc[i];
+    }
+    res = res && verifyData(pRecover[0], &buf[0], 1, SIZE)
+            && verifyData(pRecover[3], &buf[3 * SIZE], 1, SIZE);
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Flip the bits of byte offset of a file */
+static bool damageFile(const std::string &name, long offset) {
+    FILE *f = fopen(name.c_str(), "r+b");
+    bool res = f != NULL && fseek(f, offset, SEEK_SET) == 0;
+    int c = res ? fgetc(f) : EOF;
+    res = res && c != EOF && fseek(f, offset, SEEK_SET) == 0 && fputc(c ^ 0xff, f) != EOF;
+    if (f != NULL) {
+        fclose(f);
+    }
+    return res;
+}
+
+/* An object written with RSfileWriter must read back through RSfile:
+ * healthy ranges as slices of the mapping, ranges of removed shard files
+ * and damaged chunks decoded from chunks which match their checksums,
+ * and a damaged file must be left out */
+static bool testFile(void) {
+    const unsigned int K = 4;
+    const unsigned int M = 3;
+    const size_t CHUNK = RSfile::HEADER_SIZE;
+    const size_t SIZE = 3 * K * CHUNK + 1234;
+    RScode<GF28Value> rs(K, CHUNK, K + M);
+    RScode<GF28Value>::Context ctx;
+    std::vector<unsigned char> object(SIZE);
+    std::vector<unsigned char> stripe((K + M) * CHUNK);
+    std::vector<unsigned char> out(SIZE);
+    char dir[] = "/tmp/RScodeTestXXXXXX";
+    bool res = mkdtemp(dir) != NULL;
+    const std::string prefix = std::string(dir) + "/obj";
+
+    cout << "Test file:" << endl;
+    for (size_t i = 0; i < SIZE; ++i) {
+        object[i] = rand() % 256;
+    }
+    RSfileWriter writer;
+    res = res && writer.create(prefix, K, M, CHUNK + 1) == RScode<GF28Value>::e_rscode_sts_construct_err;
+    res = res && writer.create(prefix, K, M, CHUNK) == RScode<GF28Value>::e_rscode_sts_ok;
+    for (size_t pos = 0; pos < SIZE && res; pos += K * CHUNK) {
+        const unsigned char *pData[K];
+        unsigned char *pParity[M];
+        const unsigned char *pChunk[K + M];
+        uint32_t crc[K + M];
+        memset(stripe.data(), 0, stripe.size());
+        memcpy(stripe.data(), &object[pos], min(K * CHUNK, SIZE - pos));
+        for (unsigned int i = 0; i < K + M; ++i) {
+            pChunk[i] = &stripe[i * CHUNK];
+            if (i < K) {
+                pData[i] = &stripe[i * CHUNK];
+            } else {
+                pParity[i - K] = &stripe[i * CHUNK];
+            }
+        }
+        res = rs.encodeStripeCrc(pData, pParity, M, CHUNK, crc) == RScode<GF28Value>::e_rscode_sts_ok
+                && writer.append(pChunk, crc) == RScode<GF28Value>::e_rscode_sts_ok;
+    }
+    res = res && writer.finish(SIZE) == RScode<GF28Value>::e_rscode_sts_ok;
+
+    /* healthy: slices, a location and the checksums */
+    RSfile file;
+    res = res && file.open(prefix) == RScode<GF28Value>::e_rscode_sts_ok
+            && file.k() == K && file.m() == M && file.objectSize() == SIZE
+            && file.stripeCount() == 4;
+    const unsigned char *p = res ? file.slice(K * CHUNK + 2 * CHUNK + 10, 500) : NULL;
+    res = res && p != NULL && memcmp(p, &object[K * CHUNK + 2 * CHUNK + 10], 500) == 0;
+    res = res && file.slice(CHUNK - 1, 2) == NULL && file.slice(SIZE - 1, 2) == NULL;
+    res = res && file.locate(K * CHUNK + 2 * CHUNK + 10).m_stripe == 1
+            && file.locate(K * CHUNK + 2 * CHUNK + 10).m_shard == 2
+            && file.locate(K * CHUNK + 2 * CHUNK + 10).m_offset == 10;
+    for (uint64_t s = 0; s < 4 && res; ++s) {
+        for (unsigned int i = 0; i < K + M && res; ++i) {
+            res = file.verify(s, i);
+        }
+    }
+    res = res && file.read(0, SIZE, out.data(), ctx) == RScode<GF28Value>::e_rscode_sts_ok
+            && out == object;
+    file.close();
+
+    /* shards 1 and 2 are gone or damaged (header), the chunk of shard 0 in
+     * stripe 1 is damaged: only reads of them decode, and never from the
+     * damaged chunk */
+    remove((prefix + ".1").c_str());
+    res = res && damageFile(prefix + ".2", 20)
+            && damageFile(prefix + ".0", RSfile::HEADER_SIZE + CHUNK + 10);
+    res = res && file.open(prefix) == RScode<GF28Value>::e_rscode_sts_ok
+            && !file.present(1) && !file.present(2) && file.present(0)
+            && !file.verify(1, 0) && file.verify(0, 0);
+    res = res && file.slice(CHUNK + 5, 10) == NULL && file.slice(5, 10) != NULL;
+    const size_t ranges[][2] = { { 0, SIZE }, { CHUNK - 3, 7 }, { 5 * CHUNK + 17, 2500 },
+            { K * CHUNK + 5, 2 * CHUNK }, { SIZE - 100, 100 } };
+    /* twice: the second pass uses the kept results of the checksums */
+    for (size_t r = 0; r < 2 * sizeof(ranges) / sizeof(ranges[0]) && res; ++r) {
+        const size_t *range = ranges[r % (sizeof(ranges) / sizeof(ranges[0]))];
+        memset(out.data(), 0, SIZE);
+        res = file.read(range[0], range[1], out.data(), ctx) == RScode<GF28Value>::e_rscode_sts_ok
+                && memcmp(out.data(), &object[range[0]], range[1]) == 0;
+    }
+    res = res && file.read(SIZE - 1, 2, out.data(), ctx) == RScode<GF28Value>::e_rscode_sts_size_err;
+    file.close();
+    /* a third damaged chunk in stripe 1 leaves fewer than k good ones */
+    res = res && damageFile(prefix + ".5", RSfile::HEADER_SIZE + CHUNK + 10);
+    res = res && file.open(prefix) == RScode<GF28Value>::e_rscode_sts_ok
+            && file.read(K * CHUNK + 5, 10, out.data(), ctx) == RScode<GF28Value>::e_rscode_sts_corrupt_err
+            && file.read(5, 10, out.data(), ctx) == RScode<GF28Value>::e_rscode_sts_ok;
+    file.close();
+    remove((prefix + ".0").c_str());
+    remove((prefix + ".3").c_str());
+    res = res && file.open(prefix) == RScode<GF28Value>::e_rscode_sts_shards_err;
+    for (unsigned int i = 0; i < K + M; ++i) {
+        remove((prefix + "." + std::to_string(i)).c_str());
+    }
+    rmdir(dir);
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Queued requests must complete in order, coalesced into batches, with
+ * the same FEC shards as encodeStripe */
+static bool testQueue(void) {
+    const unsigned int K = 4;
+    const unsigned int M = 2;
+    const unsigned int SIZE = 4096;
+    const unsigned int REQUESTS = 64;
+    RScode<GF28Value> rs(K, SIZE);
+    std::vector<unsigned char> buf(REQUESTS * (K + M) * SIZE);
+    std::vector<unsigned char> expect(M * SIZE);
+    std::vector<const unsigned char*> pData(REQUESTS * K);
+    std::vector<unsigned char*> pParity(REQUESTS * M);
+    std::vector<unsigned int> order;
+    bool res = true;
+
+    cout << "Test queue:" << endl;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int r = 0; r < REQUESTS; ++r) {
+        for (unsigned int i = 0; i < K + M; ++i) {
+            unsigned char *shard = &buf[(r * (K + M) + i) * SIZE];
+            if (i < K) {
+                pData[r * K + i] = shard;
+            } else {
+                pParity[r * M + i - K] = shard;
+            }
+        }
+    }
+    {
+        /* the delay is never reached: batches are cut by their size and by
+         * flush only, 16 + 16 then 5 */
+        RSqueue<GF28Value> queue(rs, 2, 16, 60000000);
+        for (unsigned int r = 0; r < REQUESTS / 2 + 5; ++r) {
+            queue.submit(&pData[r * K], &pParity[r * M], M, SIZE,
+                    [&order, r](RScode<GF28Value>::E_RSCODE_STS sts) {
+                order.push_back(sts == RScode<GF28Value>::e_rscode_sts_ok ? r : ~0u);
+            });
+        }
+        queue.flush();
+        res = order.size() == REQUESTS / 2 + 5 && queue.batches() == 3 && res;
+        for (unsigned int r = 0; r < order.size(); ++r) {
+            res = order[r] == r && res;
+        }
+    }
+    {
+        RSqueue<GF28Value> queue(rs, 2, 16, 100000);
+        /* futures from several threads, completed by the destructor */
+        std::vector<std::thread> threads;
+        std::atomic<bool> ok(true);
+        for (unsigned int t = 0; t < 4; ++t) {
+            threads.push_back(std::thread([&, t]() {
+                for (unsigned int r = REQUESTS / 2 + t; r < REQUESTS; r += 4) {
+                    if (queue.submit(&pData[r * K], &pParity[r * M], M, SIZE).get()
+                            != RScode<GF28Value>::e_rscode_sts_ok) {
+                        ok = false;
+                    }
+                }
+            }));
+        }
+        for (unsigned int t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+        res = ok && res;
+        res = queue.submit(&pData[0], &pParity[0], 256, SIZE).get()
+                == RScode<GF28Value>::e_rscode_sts_limit_err && res;
+    }
+    {
+        /* mixed shapes in one batch, and a callback which submits and
+         * flushes: the delay is never reached, so the last request is
+         * dispatched by the flush of the callback */
+        RSqueue<GF28Value> queue(rs, 2, 16, 60000000);
+        std::promise<RScode<GF28Value>::E_RSCODE_STS> last;
+        std::atomic<unsigned int> ok(0);
+        for (unsigned int r = 0; r < 10; ++r) {
+            memset(pParity[r * M], 0, SIZE);
+        }
+        for (unsigned int r = 0; r < 9; ++r) {
+            queue.submit(&pData[r * K], &pParity[r * M], r % 3 ? M : 1, SIZE,
+                    [&, r](RScode<GF28Value>::E_RSCODE_STS sts) {
+                if (sts == RScode<GF28Value>::e_rscode_sts_ok) {
+                    ++ok;
+                }
+                if (r == 8) {
+                    queue.submit(&pData[9 * K], &pParity[9 * M], M, SIZE,
+                            [&last](RScode<GF28Value>::E_RSCODE_STS sts) {
+                        last.set_value(sts);
+                    });
+                    queue.flush();
+                }
+            });
+        }
+        queue.flush();
+        res = ok == 9 && res;
+        res = last.get_future().get() == RScode<GF28Value>::e_rscode_sts_ok && res;
+    }
+    for (unsigned int r = 0; r < REQUESTS; ++r) {
+        unsigned char *pExpect[M] = { &expect[0], &expect[SIZE] };
+        rs.encodeStripe(&pData[r * K], pExpect, M, SIZE);
+        res = memcmp(&expect[0], pParity[r * M], SIZE) == 0
+                && memcmp(&expect[SIZE], pParity[r * M + 1], SIZE) == 0 && res;
+    }
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Trace events received by testStats */
+static unsigned int s_traceEvents[3];
 
+static void traceHook(const RSstats::TraceEvent &event) {
+    s_traceEvents[event.m_type]++;
+}
+
+/* Counters of one encoding and one decoding */
+static bool testStats(void) {
+    const unsigned int K = 5;
+    const unsigned int M = 2;
+    const unsigned int SIZE = 10000;
+    std::vector<unsigned char> buf((K + M + K) * SIZE);
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned char *pRecover[K];
+    RScode<GF28Value>::Shard shards[K];
+    bool res = true;
+
+    cout << "Test stats:" << endl;
+    RSstats::reset();
+    RSstats::setTraceHook(traceHook);
+    RScode<GF28Value> rs(K, SIZE);
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = &buf[i * SIZE];
+        pRecover[i] = &buf[(K + M + i) * SIZE];
+        shards[i].index = (i < M) ? K + i : i;
+        shards[i].data = &buf[shards[i].index * SIZE];
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = &buf[(K + i) * SIZE];
+    }
+    res = rs.encodeStripe(pData, pParity, M, SIZE) == 0 && res;
+    res = rs.decode(shards, K, pRecover, SIZE) == 0 && res;
+    res = rs.decode(shards, K, pRecover, SIZE) == 0 && res;
+    RSstats::setTraceHook(NULL);
+    RSstats::Snapshot s = RSstats::snapshot();
+    if (RSstats::ENABLED) {
+        res = s.m_counter[RSstats::e_rs_stat_encode_calls] == 1
+                && s.m_counter[RSstats::e_rs_stat_encode_bytes] == K * SIZE
+                && s.m_counter[RSstats::e_rs_stat_decode_calls] == 2
+                && s.m_counter[RSstats::e_rs_stat_decode_bytes] == 2 * M * SIZE
+                && s.m_counter[RSstats::e_rs_stat_plan_hits] == 1
+                && s.m_counter[RSstats::e_rs_stat_plan_misses] == 1
+                && s.m_counter[RSstats::e_rs_stat_allocations] == 2
+                && s.m_kernelCalls[GF28Region::kernel()] > 0
+                && s.percentile(RSstats::e_rs_hist_decode, 1.0) > 0
+                && s_traceEvents[RSstats::e_rs_trace_encode] == 1
+                && s_traceEvents[RSstats::e_rs_trace_decode] == 2
+                && s_traceEvents[RSstats::e_rs_trace_invert] == 1 && res;
+    }
+    RSstats::reset();
+    s = RSstats::snapshot();
+    res = s.m_counter[RSstats::e_rs_stat_encode_calls] == 0 && res;
+    /* the engine counts a stripe once, whatever the slices it runs */
+    {
+        RSengine<GF28Value> engine(rs, 2, 4096);
+        res = engine.encodeStripe(pData, pParity, M, SIZE) == 0 && res;
+        res = engine.decode(shards, K, pRecover, SIZE) == 0 && res;
+    }
+    s = RSstats::snapshot();
+    if (RSstats::ENABLED) {
+        res = s.m_counter[RSstats::e_rs_stat_encode_calls] == 1
+                && s.m_counter[RSstats::e_rs_stat_encode_bytes] == K * SIZE
+                && s.m_counter[RSstats::e_rs_stat_decode_calls] == 1
+                && s.m_counter[RSstats::e_rs_stat_decode_bytes] == M * SIZE && res;
+    }
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* RSengine must give the same results as RScode */
+static bool testEngine(void) {
+    const unsigned int K = 6;
+    const unsigned int M = 3;
+    const unsigned int STRIPES = 5;
+    const unsigned int SIZE = 100000 + 7;
+    RScode<GF28Value> rs(K, SIZE);
+    RSengine<GF28Value> engine(rs, 4, 4096);
+    unsigned char *buf = new unsigned char[STRIPES * (K + M * 2) * SIZE];
+    const unsigned char *pData[STRIPES][K];
+    unsigned char *pParity[STRIPES][M];
+    unsigned char *pExpect[STRIPES][M];
+    const unsigned char * const *data[STRIPES];
+    unsigned char * const *parity[STRIPES];
+    bool res = true;
+
+    cout << "Test engine(" << engine.threadCount() << " threads):" << endl;
+    for (unsigned int s = 0; s < STRIPES; ++s) {
+        unsigned char *p = buf + s * (K + M * 2) * SIZE;
+        for (unsigned int i = 0; i < K; ++i) {
+            pData[s][i] = p + i * SIZE;
+            for (unsigned int j = 0; j < SIZE; ++j) {
+                p[i * SIZE + j] = rand() % 256;
+            }
+        }
+        for (unsigned int i = 0; i < M; ++i) {
+            pParity[s][i] = p + (K + i) * SIZE;
+            pExpect[s][i] = p + (K + M + i) * SIZE;
+        }
+        rs.encodeStripe(pData[s], pExpect[s], M, SIZE);
+        data[s] = pData[s];
+        parity[s] = pParity[s];
+    }
+    engine.encodeStripes(data, parity, STRIPES, M, SIZE);
+    for (unsigned int s = 0; s < STRIPES; ++s) {
+        for (unsigned int i = 0; i < M; ++i) {
+            res = verifyData(pExpect[s][i], pParity[s][i], 1, SIZE) && res;
+        }
+    }
+    /* lose data lines 1, 2 and 4 of stripe 0 */
+    RScode<GF28Value>::Shard shards[K] = { { 7, pParity[0][1] }, { 0, pData[0][0] },
+            { 3, pData[0][3] }, { 8, pParity[0][2] }, { 5, pData[0][5] },
+            { 6, pParity[0][0] } };
+    unsigned char *recover[K] = { NULL, pExpect[1][0], pExpect[1][1], NULL,
+            pExpect[1][2], NULL };
+    if (engine.decode(shards, K, recover, SIZE) != 0) {
+        res = false;
+    }
+    res = verifyData((unsigned char *) pData[0][1], recover[1], 1, SIZE) && res;
+    res = verifyData((unsigned char *) pData[0][2], recover[2], 1, SIZE) && res;
+    res = verifyData((unsigned char *) pData[0][4], recover[4], 1, SIZE) && res;
+    /* threads decoding different stripes with the same engine, a Context
+     * each */
+    {
+        const unsigned int THREADS = 4;
+        std::atomic<bool> ok(true);
+        vector<unsigned char> out(THREADS * 2 * SIZE);
+        vector<std::thread> threads;
+        for (unsigned int t = 0; t < THREADS; ++t) {
+            threads.push_back(std::thread([&, t] {
+                const unsigned int s = t % STRIPES;
+                RSengine<GF28Value>::Context ctx;
+                RScode<GF28Value>::Shard lost[K];
+                unsigned char *to[K] = { NULL };
+                for (unsigned int i = 0; i < K; ++i) {
+                    lost[i].index = (i < 2) ? K + i : i;
+                    lost[i].data = (i < 2) ? pParity[s][i] : pData[s][i];
+                }
+                to[0] = &out[t * 2 * SIZE];
+                to[1] = &out[(t * 2 + 1) * SIZE];
+                for (int n = 0; n < 20 && ok; ++n) {
+                    if (engine.decode(lost, K, to, SIZE, ctx) != RScode<GF28Value>::e_rscode_sts_ok
+                            || memcmp(to[0], pData[s][0], SIZE) != 0
+                            || memcmp(to[1], pData[s][1], SIZE) != 0) {
+                        ok = false;
+                    }
+                }
+            }));
+        }
+        for (unsigned int t = 0; t < THREADS; ++t) {
+            threads[t].join();
+        }
+        res = ok && res;
+    }
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Encode k data lines to all limit - k FEC lines, then decode from random
+ * sets of k lines in random order */
+template<typename T>
+static bool _doWideTest(unsigned int k, unsigned int limit, size_t size,
+        unsigned int rounds) {
+    RScode<T> rs(k, size, limit);
+    unsigned char *buf = new unsigned char[(limit + k) * size];
+    vector<const unsigned char *> pData(k);
+    vector<unsigned char *> pParity(limit - k);
+    vector<unsigned char *> pRecover(k);
+    vector<unsigned int> lines(limit);
+    bool res = rs.error() == RScode<T>::e_rscode_sts_ok;
+
+    for (size_t i = 0; i < k * size; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < limit; ++i) {
+        lines[i] = i;
+        if (i < k) {
+            pData[i] = buf + i * size;
+            pRecover[i] = buf + (limit + i) * size;
+        } else {
+            pParity[i - k] = buf + i * size;
+        }
+    }
+    res = res && rs.encodeStripe(pData.data(), pParity.data(), limit - k, size) == 0;
+    for (unsigned int n = 0; n < rounds && res; ++n) {
+        for (unsigned int i = limit - 1; i > 0; --i) {
+            std::swap(lines[i], lines[rand() % (i + 1)]);
+        }
+        vector<typename RScode<T>::Shard> shards(k);
+        for (unsigned int i = 0; i < k; ++i) {
+            shards[i].index = lines[i];
+            shards[i].data = buf + lines[i] * size;
+        }
+        memset(buf + limit * size, 0, k * size);
+        res = rs.decode(shards.data(), k, pRecover.data(), size) == 0;
+        for (unsigned int i = 0; i < k && res; ++i) {
+            if (find(lines.begin(), lines.begin() + k, i) == lines.begin() + k) {
+                res = verifyData((unsigned char *) pData[i], pRecover[i], 1, size);
+            }
+        }
+    }
+    delete[] buf;
+    return res;
+}
+
+/* Check GF(2^4) and GF(2^16) fields, their region kernels and codes wider
+ * than 256 lines */
+static bool testWideField(void) {
+    const unsigned int SIZE = 302;
+    unsigned char src[SIZE];
+    unsigned char dst[SIZE];
+    unsigned char expect[SIZE];
+    GF2wKernel::E_GF2W_KERNEL best = GF2wKernel::kernel();
+    bool res = true;
+
+    cout << "Test wide field:" << endl;
+    for (unsigned int a = 0; a < 16; ++a) {
+        for (unsigned int b = 0; b < 16; ++b) {
+            res = res && (GF24Value(a) * GF24Value(b)).value() == slowMultiply(a, b, 4, 0x13);
+        }
+    }
+    for (unsigned int a = 1; a < 65536; ++a) {
+        unsigned int b = rand() % 65536;
+        unsigned int r = slowMultiply(a, b, 16, 0x1100B);
+        res = res && (GF216Value(a) * GF216Value(b)).value() == r;
+        res = res && (GF216Value(r) / GF216Value(a)).value() == b;
+        res = res && slowMultiply(GF216Value(a).inverse().value(), a, 16, 0x1100B) == 1;
+    }
+    for (unsigned int i = 0; i < SIZE; ++i) {
+        src[i] = rand() % 256;
+    }
+    for (int k = 0; k < GF2wKernel::e_gf2w_kernel_max; ++k) {
+        GF2wKernel::E_GF2W_KERNEL kernel = (GF2wKernel::E_GF2W_KERNEL) k;
+        if (!GF2wKernel::setKernel(kernel)) {
+            cout << GF2wKernel::kernelName(kernel) << " not supported." << endl;
+            continue;
+        }
+        bool ok = true;
+        for (unsigned int n = 0; n < 64 && ok; ++n) {
+            unsigned int c = (n == 0) ? 1 : rand() % 65536;
+            unsigned int len = SIZE - 2 * n;
+            for (unsigned int i = 0; i < len; i += 2) {
+                unsigned int x = (GF216Value(c) * GF216Value(src[i] | (src[i + 1] << 8))).value();
+                expect[i] = x & 0xff;
+                expect[i + 1] = (x >> 8) ^ i;
+                dst[i] = 0;
+                dst[i + 1] = i;
+            }
+            GF216Value::Region::multiplyAdd(dst, src, c, len);
+            ok = ok && memcmp(dst, expect, len) == 0;
+            c %= 16;
+            for (unsigned int i = 0; i < len; ++i) {
+                expect[i] = (GF24Value(c) * GF24Value(src[i])).value()
+                        | ((GF24Value(c) * GF24Value(src[i] >> 4)).value() << 4);
+            }
+            GF24Value::Region::multiply(dst, src, c, len);
+            ok = ok && memcmp(dst, expect, len) == 0;
+        }
+        cout << GF2wKernel::kernelName(kernel) << (ok ? " ok." : " error.") << endl;
+        res = res && ok;
+    }
+    GF2wKernel::setKernel(best);
+    res = _doWideTest<GF24Value>(5, 16, 301, 20) && res;
+    res = _doWideTest<GF216Value>(20, 300, 1002, 20) && res;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* Corrupt one shard (or two) of a stripe, verify must locate it and repair
+ * must restore it */
+template<typename T>
+static bool _doVerifyTest(unsigned int k, unsigned int m, size_t size) {
+    typedef RScode<T> RS;
+    RS rs(k, size, k + m);
+    typename RS::Context ctx;
+    vector<unsigned char> buf((k + m) * size);
+    vector<unsigned char> copy;
+    vector<unsigned char *> pData(k);
+    vector<unsigned char *> pParity(m);
+    unsigned int corrupt = 0;
+
+    for (size_t i = 0; i < k * size; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < k + m; ++i) {
+        if (i < k) {
+            pData[i] = &buf[i * size];
+        } else {
+            pParity[i - k] = &buf[i * size];
+        }
+    }
+    const unsigned char * const *data = (const unsigned char * const *) pData.data();
+    const unsigned char * const *parity = (const unsigned char * const *) pParity.data();
+    bool res = rs.encodeStripe(data, pParity.data(), m, size) == RS::e_rscode_sts_ok;
+    copy = buf;
+    res = rs.verify(data, parity, m, size, &corrupt, ctx) == RS::e_rscode_sts_ok
+            && corrupt == rs.limit() && res;
+    for (unsigned int row = 0; row < k + m; ++row) {
+        /* a burst in the last block of the shard */
+        size_t at = size - 1 - rand() % 100;
+        buf[row * size + at] ^= 1 + rand() % 255;
+        buf[row * size + at / 2] ^= 0x5a;
+        res = rs.verify(data, parity, m, size, &corrupt, ctx)
+                == RS::e_rscode_sts_corrupt_err && corrupt == row && res;
+        res = rs.repair(pData.data(), pParity.data(), m, size, &corrupt, ctx)
+                == RS::e_rscode_sts_ok && corrupt == row && buf == copy && res;
+    }
+    /* two corrupt shards */
+    buf[0] ^= 1;
+    buf[(k + m - 1) * size + size / 2] ^= 1;
+    res = rs.repair(pData.data(), pParity.data(), m, size, &corrupt, ctx)
+            == RS::e_rscode_sts_uncorrectable_err && res;
+    /* one FEC shard detects only */
+    buf = copy;
+    buf[size] ^= 1;
+    res = rs.verify(data, parity, 1, size, &corrupt, ctx)
+            == RS::e_rscode_sts_uncorrectable_err && res;
+    return res;
+}
+
+static bool testVerify(void) {
+    cout << "Test verify:" << endl;
+    bool res = _doVerifyTest<GF28Value>(10, 4, 3 * 8192 + 100);
+    res = _doVerifyTest<GF28Value>(3, 2, 100) && res;
+    res = _doVerifyTest<GF24Value>(5, 3, 9000) && res;
+    res = _doVerifyTest<GF216Value>(6, 3, 20002) && res;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* RSxorCode FEC shards must match a symbol by symbol calculation (symbol
+ * bit j is in packet j), and every set of k shards must decode */
+static bool testXorCode(void) {
+    const unsigned int K = 5;
+    const unsigned int M = 3;
+    const unsigned int PACKET = 64;
+    const size_t SIZE = 2 * 8 * PACKET + 8 * 3;
+    RSxorCode rs(K, M, PACKET);
+    unsigned char *buf = new unsigned char[(K + M + K) * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    unsigned char *pRecover[K];
+    bool res = rs.error() == RScode<GF28Value>::e_rscode_sts_ok;
+
+    cout << "Test xor code(" << rs.encodeOperations() << " operations per unit):" << endl;
+    for (size_t i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+        pRecover[i] = buf + (K + M + i) * SIZE;
+        res = res && rs.coefficient(0, i) == 1;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+    }
+    res = res && rs.encode(pData, pParity, SIZE) == 0;
+    for (size_t unit = 0; unit < SIZE && res; unit += 8 * PACKET) {
+        size_t len = min((size_t) PACKET, (SIZE - unit) / 8);
+        for (size_t p = 0; p < len; ++p) {
+            for (unsigned int b = 0; b < 8; ++b) {
+                for (unsigned int r = 0; r < M; ++r) {
+                    GF28Value y(0);
+                    for (unsigned int d = 0; d < K; ++d) {
+                        unsigned int x = 0;
+                        for (unsigned int j = 0; j < 8; ++j) {
+                            x |= ((pData[d][unit + j * len + p] >> b) & 1) << j;
+                        }
+                        y = y + GF28Value(rs.coefficient(r, d)) * GF28Value(x);
+                    }
+                    for (unsigned int i = 0; i < 8; ++i) {
+                        if (((pParity[r][unit + i * len + p] >> b) & 1)
+                                != ((y.value() >> i) & 1)) {
+                            res = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    /* every subset of K of the K + M shards */
+    for (unsigned int set = 0; set < (1u << (K + M)) && res; ++set) {
+        if (__builtin_popcount(set) != K) {
+            continue;
+        }
+        RSxorCode::Shard shards[K];
+        unsigned int n = 0;
+        for (unsigned int i = K + M; i-- > 0;) {
+            if (set & (1u << i)) {
+                shards[n].index = i;
+                shards[n++].data = buf + i * SIZE;
+            }
+        }
+        memset(pRecover[0], 0, K * SIZE);
+        res = rs.decode(shards, K, pRecover, SIZE) == 0;
+        for (unsigned int i = 0; i < K && res; ++i) {
+            if (!(set & (1u << i))) {
+                res = verifyData((unsigned char *) pData[i], pRecover[i], 1, SIZE);
+            }
+        }
+    }
+    /* status of the Context methods, the code's own status is untouched */
+    {
+        RSxorCode::Context ctx;
+        RSxorCode::Shard shards[K];
+        for (unsigned int i = 0; i < K; ++i) {
+            shards[i].index = K + M - 1 - i;
+            shards[i].data = buf + shards[i].index * SIZE;
+        }
+        memset(pRecover[0], 0, K * SIZE);
+        res = res && rs.decode(shards, K, pRecover, SIZE, ctx) == RScode<GF28Value>::e_rscode_sts_ok;
+        for (unsigned int i = 0; i < K - M && res; ++i) {
+            res = verifyData((unsigned char *) pData[i], pRecover[i], 1, SIZE);
+        }
+        res = res && rs.decode(shards, K - 1, pRecover, SIZE, ctx) == RScode<GF28Value>::e_rscode_sts_shards_err
+                && ctx.error() == RScode<GF28Value>::e_rscode_sts_shards_err;
+        res = res && rs.decode(shards, K, pRecover, SIZE - 1, ctx) == RScode<GF28Value>::e_rscode_sts_size_err;
+        res = res && rs.error() == RScode<GF28Value>::e_rscode_sts_ok;
+        RSxorCode bad(0, M);
+        bad.setDecodeCacheSize(1);
+        res = res && bad.error() == RScode<GF28Value>::e_rscode_sts_construct_err
+                && bad.decodeCacheHits() == 0 && bad.decodeCacheMisses() == 0
+                && bad.decode(shards, K, pRecover, SIZE, ctx) == RScode<GF28Value>::e_rscode_sts_construct_err;
+    }
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+/* RSlrcCode repair plans: a lone loss reads its group, the rest fall back
+ * to the global parities, and every repaired shard must match */
+static bool testLrc(void) {
+    typedef RSlrcCode::E_RSCODE_STS E_STS;
+    const unsigned int K = 12;
+    const unsigned int L = 3;
+    const unsigned int G = 2;
+    const unsigned int N = K + L + G;
+    const size_t SIZE = 1000;
+    RSlrcCode lrc(K, L, G);
+    unsigned char *buf = new unsigned char[2 * N * SIZE];
+    unsigned char *pShard[N];
+    bool res = lrc.error() == RScode<GF28Value>::e_rscode_sts_ok;
+
+    cout << "Test lrc code:" << endl;
+    for (size_t i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < N; ++i) {
+        pShard[i] = buf + (N + i) * SIZE;
+    }
+    const unsigned char *pData[K];
+    unsigned char *pParity[L + G];
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+    }
+    for (unsigned int i = 0; i < L + G; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+    }
+    res = res && lrc.encode(pData, pParity, SIZE) == RScode<GF28Value>::e_rscode_sts_ok;
+    /* local parities are the xor of their group, globals match RScode */
+    for (unsigned int g = 0; g < L && res; ++g) {
+        for (size_t j = 0; j < SIZE; ++j) {
+            unsigned char x = 0;
+            for (unsigned int i = lrc.groupFirst(g); i < lrc.groupLast(g); ++i) {
+                x ^= pData[i][j];
+            }
+            res = res && x == pParity[g][j];
+        }
+    }
+    {
+        RScode<GF28Value> rs(K, 1, K + G);
+        unsigned char *pGlobal[G];
+        for (unsigned int i = 0; i < G; ++i) {
+            pGlobal[i] = buf + (N + i) * SIZE;
+        }
+        res = res && rs.encodeStripe(pData, pGlobal, G, SIZE) == RScode<GF28Value>::e_rscode_sts_ok;
+        for (unsigned int i = 0; i < G; ++i) {
+            res = res && verifyData(pParity[L + i], pGlobal[i], 1, SIZE);
+        }
+    }
+
+    struct {
+        unsigned int lost[4];
+        unsigned int count;
+        E_STS sts;
+        bool local;
+        unsigned int reads;
+    } cases[] = {
+        {{5}, 1, RScode<GF28Value>::e_rscode_sts_ok, true, 4},             /* data, local */
+        {{K + 1}, 1, RScode<GF28Value>::e_rscode_sts_ok, true, 4},         /* local parity */
+        {{0, 8}, 2, RScode<GF28Value>::e_rscode_sts_ok, true, 8},          /* two groups */
+        {{4, 6}, 2, RScode<GF28Value>::e_rscode_sts_ok, false, K},         /* one group */
+        {{0, 4, 8, 11}, 4, RScode<GF28Value>::e_rscode_sts_ok, false, 0},
+        {{K + L + 1}, 1, RScode<GF28Value>::e_rscode_sts_ok, false, K},    /* global parity */
+        {{4, 5, 6, 7}, 4, RScode<GF28Value>::e_rscode_sts_shards_err, false, 0},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]) && res; ++c) {
+        RSlrcCode::RepairPlan plan;
+        E_STS sts = lrc.planRepair(cases[c].lost, cases[c].count, plan);
+        res = sts == cases[c].sts;
+        if (sts != RScode<GF28Value>::e_rscode_sts_ok) {
+            continue;
+        }
+        res = res && plan.m_local == cases[c].local;
+        res = res && (cases[c].reads == 0 || plan.m_read.size() == cases[c].reads);
+        /* only the planned shards are present */
+        memset(buf + N * SIZE, 0, N * SIZE);
+        for (size_t r = 0; r < plan.m_read.size(); ++r) {
+            memcpy(pShard[plan.m_read[r]], buf + plan.m_read[r] * SIZE, SIZE);
+        }
+        res = res && lrc.repair(plan, pShard, SIZE) == RScode<GF28Value>::e_rscode_sts_ok;
+        for (unsigned int i = 0; i < cases[c].count && res; ++i) {
+            const unsigned int r = cases[c].lost[i];
+            res = verifyData(buf + r * SIZE, pShard[r], 1, SIZE);
+        }
+    }
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
+}
+
+static bool testProgressive(void) {
+    typedef RScode<GF28Value> RS;
+    const unsigned int K = 10;
+    const unsigned int M = 6;
+    const size_t SIZE = 1024;
+    RS rs(K, 1, K + M);
+    unsigned char *buf = new unsigned char[(K + M) * SIZE];
+    const unsigned char *pData[K];
+    unsigned char *pParity[M];
+    bool res = true;
+
+    cout << "Test progressive decode:" << endl;
+    for (size_t i = 0; i < K * SIZE; ++i) {
+        buf[i] = rand() % 256;
+    }
+    for (unsigned int i = 0; i < K; ++i) {
+        pData[i] = buf + i * SIZE;
+    }
+    for (unsigned int i = 0; i < M; ++i) {
+        pParity[i] = buf + (K + i) * SIZE;
+    }
+    res = rs.encodeStripe(pData, pParity, M, SIZE) == RS::e_rscode_sts_ok;
+
+    RSdecoder<GF28Value> decoder(rs, SIZE);
+    vector<unsigned int> order(K + M);
+    for (int t = 0; t < 200 && res; ++t) {
+        /* any arrival order of data and FEC shards, with repeats */
+        for (unsigned int i = 0; i < K + M; ++i) {
+            order[i] = i;
+        }
+        for (unsigned int i = K + M - 1; i > 0; --i) {
+            swap(order[i], order[rand() % (i + 1)]);
+        }
+        decoder.reset();
+        for (unsigned int i = 0; i < K + M && !decoder.complete() && res; ++i) {
+            const unsigned int before = decoder.rank();
+            res = decoder.line(0) == NULL;
+            res = res && decoder.add(order[i], buf + order[i] * SIZE) == RS::e_rscode_sts_ok;
+            res = res && decoder.rank() == before + 1;
+            if (rand() % 4 == 0 && !decoder.complete()) {
+                const unsigned int r = order[rand() % (i + 1)];
+                res = res && decoder.add(r, buf + r * SIZE) == RS::e_rscode_sts_singular_err;
+                res = res && decoder.rank() == before + 1;
+            }
+        }
+        res = res && decoder.complete();
+        res = res && decoder.add(order[K + M - 1], buf + order[K + M - 1] * SIZE)
+                == RS::e_rscode_sts_ok;
+        for (unsigned int i = 0; i < K && res; ++i) {
+            res = decoder.line(i) != NULL && memcmp(decoder.line(i), pData[i], SIZE) == 0;
+        }
+    }
+    /* FEC shards first: once the buffers of a stripe exist, the next
+     * stripe allocates nothing */
+    for (int t = 0; t < 2 && res; ++t) {
+        const unsigned long long before = g_allocations.load();
+        decoder.reset();
+        for (unsigned int i = 0; i < K + M && !decoder.complete() && res; ++i) {
+            const unsigned int r = (K + i) % (K + M);
+            res = decoder.add(r, buf + r * SIZE) == RS::e_rscode_sts_ok;
+        }
+        for (unsigned int i = 0; i < K && res; ++i) {
+            res = decoder.line(i) != NULL && memcmp(decoder.line(i), pData[i], SIZE) == 0;
+        }
+        if (t == 1 && g_allocations.load() != before) {
+            cout << g_allocations.load() - before << " allocations." << endl;
+            res = false;
+        }
+    }
+    /* a failed call without Context on the shared codec does not affect
+     * the sessions */
+    {
+        RS::Shard one = { 0, pData[0] };
+        unsigned char *pOut[K] = { NULL };
+        res = res && rs.decode(&one, 1, pOut, SIZE) != 0
+                && rs.error() == RS::e_rscode_sts_shards_err;
+        decoder.reset();
+        res = res && decoder.add(0, pData[0]) == RS::e_rscode_sts_ok && decoder.rank() == 1;
+        RS bad(0, SIZE);
+        RSdecoder<GF28Value> badDecoder(bad, SIZE);
+        res = res && badDecoder.add(0, pData[0]) == RS::e_rscode_sts_construct_err;
+    }
+    /* data line 0 arrives after the FEC row which has it as pivot */
+    decoder.reset();
+    res = res && decoder.add(K, pParity[0]) == RS::e_rscode_sts_ok;
+    res = res && decoder.add(0, pData[0]) == RS::e_rscode_sts_ok;
+    res = res && decoder.add(K + M, pParity[0]) == RS::e_rscode_sts_index_err;
+    for (unsigned int i = 2; i < K; ++i) {
+        res = res && decoder.add(i, pData[i]) == RS::e_rscode_sts_ok;
+    }
+    res = res && decoder.complete() && memcmp(decoder.line(1), pData[1], SIZE) == 0;
+
+    delete[] buf;
+    cout << (res ? "ok." : "error.") << endl;
+    return res;
 }
 
 int main(void) {
-    testAll();
-    return 0;
+    srand(time(NULL));
+    bool res = testField();
+    res = testRegion() && res;
+    res = testEncodeStripe() && res;
+    res = testLazyMatrix() && res;
+    res = testDecodeCache() && res;
+    res = testUpdateParity() && res;
+    res = testWorkspace() && res;
+    res = testSharedCodec() && res;
+    res = testReconstruct() && res;
+    res = testDecodeStripes() && res;
+    res = testDecodeRange() && res;
+    res = testCrc() && res;
+    res = testFile() && res;
+    res = testEngine() && res;
+    res = testQueue() && res;
+    res = testStats() && res;
+    res = testWideField() && res;
+    res = testVerify() && res;
+    res = testXorCode() && res;
+    res = testLrc() && res;
+    res = testProgressive() && res;
+    res = testAll() && res;
+    return res ? 0 : 1;
 }
 
@@ -0,0 +1,69 @@
+/*
+ * RScodeTestAlloc.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+using namespace std;
+
+/* Heap allocations of RScodeTest: the whole family of the global
+ * operators is replaced, on malloc/free. They are in their own translation
+ * unit so that the callers only see matching new/delete pairs. */
+std::atomic<unsigned long long> g_allocations(0);
+
+static void* countedAlloc(size_t size) noexcept {
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void *p = countedAlloc(size);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void *p = countedAlloc(size);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    free(p);
+}
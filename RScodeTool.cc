@@ -0,0 +1,463 @@
+/*
+ * RScodeTool.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "GF28Value.hh"
+#include "RScode.hh"
+#include "RSengine.hh"
+#include "RSfile.hh"
+#include "Crc32c.hh"
+
+using namespace std;
+
+/* Streaming file encoder/decoder.
+ * encode: the input is cut into stripes of k chunks, each stripe is encoded
+ *         and chunk i of every stripe is appended to shard file <prefix>.i
+ *         (0 <= i < k + m), in the RSfile format. The chunk size is a
+ *         multiple of 4096 (default 1M).
+ * decode: the file is rebuilt from any k shard files, chunks which do not
+ *         match their checksum are decoded like missing ones.
+ * Reading, coding and writing run as separate threads connected by bounded
+ * queues, so they overlap. Regular input files and shard files are mmap'ed
+ * and coded in place.
+ *  */
+
+static const unsigned int QUEUE_DEPTH = 4;      /* Stripes in flight per stage */
+
+/* Queue with bounded capacity between two pipeline stages */
+template<typename E>
+class BoundedQueue {
+public:
+    BoundedQueue(size_t capacity) :
+            m_capacity(capacity) {
+    }
+    void push(const E &e) {
+        unique_lock<mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_queue.size() < m_capacity; });
+        m_queue.push(e);
+        m_notEmpty.notify_one();
+    }
+    E pop(void) {
+        unique_lock<mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return !m_queue.empty(); });
+        E e = m_queue.front();
+        m_queue.pop();
+        m_notFull.notify_one();
+        return e;
+    }
+private:
+    size_t m_capacity;
+    queue<E> m_queue;
+    mutex m_mutex;
+    condition_variable m_notFull;
+    condition_variable m_notEmpty;
+};
+
+/* One stripe travelling through the pipeline */
+struct Stripe {
+    vector<unsigned char> m_buf;            /* Chunks not mapped from a file */
+    vector<const unsigned char*> m_data;    /* Data chunks (encode) */
+    vector<RScode<GF28Value>::Shard> m_shards;  /* Survivor chunks (decode) */
+    vector<unsigned char*> m_out;           /* FEC (encode) or data (decode) chunks */
+    vector<uint32_t> m_crc;                 /* Checksums of the chunks (encode) */
+    size_t m_bytes;                         /* Bytes of the file in this stripe */
+    bool m_last;                            /* End of stream */
+    bool m_error;
+};
+
+static bool writeAll(int fd, const unsigned char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static size_t readAll(int fd, unsigned char *p, size_t len, bool &error) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = read(fd, p + total, len - total);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            error = true;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+/* Run reader, coder and writer as a three stage pipeline over
+ * QUEUE_DEPTH stripes. Each stage returns false to stop the stream. */
+static bool runPipeline(vector<Stripe> &stripes,
+        const function<bool(Stripe &)> &reader,
+        const function<bool(Stripe &)> &coder,
+        const function<bool(Stripe &)> &writer) {
+    BoundedQueue<Stripe*> freeQueue(stripes.size());
+    BoundedQueue<Stripe*> readQueue(stripes.size());
+    BoundedQueue<Stripe*> codedQueue(stripes.size());
+    for (size_t i = 0; i < stripes.size(); ++i) {
+        freeQueue.push(&stripes[i]);
+    }
+    thread readThread([&] {
+        for (;;) {
+            Stripe *s = freeQueue.pop();
+            s->m_error = false;
+            s->m_last = !reader(*s);
+            readQueue.push(s);
+            if (s->m_last) {
+                break;
+            }
+        }
+    });
+    thread codeThread([&] {
+        for (;;) {
+            Stripe *s = readQueue.pop();
+            if (!s->m_error && s->m_bytes > 0 && !coder(*s)) {
+                s->m_error = true;
+            }
+            codedQueue.push(s);
+            if (s->m_last) {
+                break;
+            }
+        }
+    });
+    bool res = true;
+    for (;;) {
+        Stripe *s = codedQueue.pop();
+        if (s->m_error || (res && s->m_bytes > 0 && !writer(*s))) {
+            res = false;
+        }
+        bool last = s->m_last;
+        freeQueue.push(s);
+        if (last) {
+            break;
+        }
+    }
+    readThread.join();
+    codeThread.join();
+    return res;
+}
+
+static int encodeFile(const string &input, const string &prefix,
+        unsigned int k, unsigned int m, size_t chunkSize,
+        unsigned int threadCount) {
+    int in = (input == "-") ? 0 : open(input.c_str(), O_RDONLY);
+    if (in < 0) {
+        cerr << "can not open " << input << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    /* Map regular files, stream everything else */
+    struct stat st;
+    const unsigned char *map = NULL;
+    uint64_t fileSize = 0;
+    if (fstat(in, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, in, 0);
+        if (p != MAP_FAILED) {
+            map = (const unsigned char *) p;
+            fileSize = st.st_size;
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+        }
+    }
+    RSfileWriter out;
+    RSfile::E_RSCODE_STS sts = out.create(prefix, k, m, chunkSize);
+    if (sts != RScode<GF28Value>::e_rscode_sts_ok) {
+        cerr << "can not create " << prefix << ".*: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    RScode<GF28Value> rs(k, chunkSize, k + m);
+    /* The engine and its pool are for several threads only */
+    unique_ptr<RSengine<GF28Value> > engine;
+    if (threadCount > 1) {
+        engine.reset(new RSengine<GF28Value>(rs, threadCount));
+    }
+    vector<Stripe> stripes(QUEUE_DEPTH);
+    for (size_t i = 0; i < stripes.size(); ++i) {
+        stripes[i].m_buf.resize((k + m) * chunkSize);
+        stripes[i].m_data.resize(k);
+        stripes[i].m_out.resize(m);
+        stripes[i].m_crc.resize(k + m);
+        for (unsigned int j = 0; j < m; ++j) {
+            stripes[i].m_out[j] = &stripes[i].m_buf[(k + j) * chunkSize];
+        }
+    }
+    const size_t stripeSize = k * chunkSize;
+    uint64_t offset = 0;
+    bool eof = false;
+    bool readError = false;
+
+    bool res = runPipeline(stripes,
+            [&](Stripe &s) {
+                if (eof) {
+                    s.m_bytes = 0;
+                    return false;
+                }
+                if (map != NULL) {
+                    s.m_bytes = min<uint64_t>(stripeSize, fileSize - offset);
+                    if (s.m_bytes == stripeSize) {
+                        for (unsigned int i = 0; i < k; ++i) {
+                            s.m_data[i] = map + offset + i * chunkSize;
+                        }
+                    } else {
+                        memcpy(&s.m_buf[0], map + offset, s.m_bytes);
+                    }
+                    eof = (offset + s.m_bytes == fileSize);
+                } else {
+                    s.m_bytes = readAll(in, &s.m_buf[0], stripeSize, readError);
+                    eof = (s.m_bytes < stripeSize);
+                    s.m_error = readError;
+                }
+                if (map == NULL || s.m_bytes < stripeSize) {
+                    memset(&s.m_buf[0] + s.m_bytes, 0, stripeSize - s.m_bytes);
+                    for (unsigned int i = 0; i < k; ++i) {
+                        s.m_data[i] = &s.m_buf[i * chunkSize];
+                    }
+                }
+                offset += s.m_bytes;
+                return !eof;
+            },
+            [&](Stripe &s) {
+                /* One thread checksums while encoding, the engine after */
+                if (threadCount <= 1) {
+                    return rs.encodeStripeCrc(s.m_data.data(), s.m_out.data(), m,
+                            chunkSize, s.m_crc.data()) == RScode<GF28Value>::e_rscode_sts_ok;
+                }
+                if (engine->encodeStripe(s.m_data.data(), s.m_out.data(), m,
+                        chunkSize) != RScode<GF28Value>::e_rscode_sts_ok) {
+                    return false;
+                }
+                for (unsigned int i = 0; i < k + m; ++i) {
+                    const unsigned char *p = (i < k) ? s.m_data[i] : s.m_out[i - k];
+                    s.m_crc[i] = Crc32c::extend(0, p, chunkSize);
+                }
+                return true;
+            },
+            [&](Stripe &s) {
+                vector<const unsigned char*> chunks(k + m);
+                for (unsigned int i = 0; i < k + m; ++i) {
+                    chunks[i] = (i < k) ? s.m_data[i] : s.m_out[i - k];
+                }
+                if (out.append(chunks.data(), s.m_crc.data()) != RScode<GF28Value>::e_rscode_sts_ok) {
+                    cerr << "write error: " << strerror(errno) << endl;
+                    return false;
+                }
+                return true;
+            });
+
+    /* The index and headers are written last, the size of a stream is
+     * known only now */
+    if (res && out.finish(offset) != RScode<GF28Value>::e_rscode_sts_ok) {
+        cerr << "write error: " << strerror(errno) << endl;
+        res = false;
+    }
+    if (map != NULL) {
+        munmap((void *) map, fileSize);
+    }
+    if (in != 0) {
+        close(in);
+    }
+    if (readError) {
+        cerr << "read error on " << input << endl;
+    }
+    return res ? 0 : 1;
+}
+
+static int decodeFile(const string &prefix, const string &output,
+        unsigned int threadCount) {
+    RSfile file;
+    RSfile::E_RSCODE_STS sts = file.open(prefix);
+    if (sts != RScode<GF28Value>::e_rscode_sts_ok) {
+        if (errno == ENOENT) {
+            cerr << "not enough shard files of " << prefix << endl;
+        } else {
+            cerr << "can not open " << prefix << ".*: " << strerror(errno) << endl;
+        }
+        return 1;
+    }
+    const unsigned int k = file.k();
+    const unsigned int n = k + file.m();
+    const size_t chunkSize = file.chunkSize();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (!file.present(i)) {
+            cerr << "ignore " << prefix << "." << i << endl;
+        }
+    }
+    int out = (output == "-") ? 1 : open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        cerr << "can not create " << output << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    unique_ptr<RSengine<GF28Value> > engine;
+    if (threadCount > 1) {
+        engine.reset(new RSengine<GF28Value>(file.code(), threadCount));
+    }
+    RScode<GF28Value>::Context ctx;         /* Of the coder stage */
+    vector<Stripe> stripes(QUEUE_DEPTH);
+    for (size_t i = 0; i < stripes.size(); ++i) {
+        stripes[i].m_buf.resize(k * chunkSize);
+        stripes[i].m_out.resize(k);
+    }
+    uint64_t stripe = 0;
+    uint64_t offset = 0;
+
+    bool res = runPipeline(stripes,
+            [&](Stripe &s) {
+                if (stripe >= file.stripeCount()) {
+                    s.m_bytes = 0;
+                    return false;
+                }
+                s.m_bytes = min<uint64_t>(k * chunkSize, file.objectSize() - offset);
+                /* The first k chunks matching their checksum, data first.
+                 * Present data chunks are written from the mapping,
+                 * missing ones are decoded into the stripe buffer. */
+                s.m_shards.clear();
+                for (unsigned int i = 0; i < n && s.m_shards.size() < k; ++i) {
+                    if (file.verify(stripe, i)) {
+                        RScode<GF28Value>::Shard shard;
+                        shard.index = i;
+                        shard.data = file.chunk(stripe, i);
+                        s.m_shards.push_back(shard);
+                    } else if (file.present(i)) {
+                        cerr << "bad checksum of " << prefix << "." << i
+                                << " in stripe " << stripe << endl;
+                    }
+                }
+                if (s.m_shards.size() < k) {
+                    cerr << "stripe " << stripe << " can not be decoded" << endl;
+                    s.m_error = true;
+                }
+                for (unsigned int i = 0; i < k; ++i) {
+                    s.m_out[i] = &s.m_buf[i * chunkSize];
+                }
+                for (size_t i = 0; i < s.m_shards.size(); ++i) {
+                    if (s.m_shards[i].index < k) {
+                        s.m_out[s.m_shards[i].index] = NULL;
+                    }
+                }
+                offset += s.m_bytes;
+                ++stripe;
+                return stripe < file.stripeCount();
+            },
+            [&](Stripe &s) {
+                if (!engine) {
+                    return file.code().decode(s.m_shards.data(), k, s.m_out.data(),
+                            chunkSize, ctx) == RScode<GF28Value>::e_rscode_sts_ok;
+                }
+                return engine->decode(s.m_shards.data(), k, s.m_out.data(),
+                        chunkSize, ctx) == RScode<GF28Value>::e_rscode_sts_ok;
+            },
+            [&](Stripe &s) {
+                size_t remain = s.m_bytes;
+                for (unsigned int i = 0; i < k && remain > 0; ++i) {
+                    const unsigned char *p = s.m_out[i];
+                    for (unsigned int j = 0; p == NULL && j < k; ++j) {
+                        if (s.m_shards[j].index == i) {
+                            p = s.m_shards[j].data;
+                        }
+                    }
+                    size_t len = min(remain, chunkSize);
+                    if (!writeAll(out, p, len)) {
+                        cerr << "write error: " << strerror(errno) << endl;
+                        return false;
+                    }
+                    remain -= len;
+                }
+                return true;
+            });
+
+    if (out != 1) {
+        close(out);
+    }
+    return res ? 0 : 1;
+}
+
+static void usage(void) {
+    cerr << "usage: RScodeTool encode [-k data] [-m fec] [-c chunk] [-t threads] input|- prefix" << endl;
+    cerr << "       RScodeTool decode [-t threads] prefix output|-" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int k = 10;
+    unsigned int m = 4;
+    size_t chunkSize = 1 << 20;
+    unsigned int threadCount = 1;
+    vector<string> args;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    for (int i = 2; i < argc; ++i) {
+        string a = argv[i];
+        if (a.size() == 2 && a[0] == '-' && i + 1 < argc) {
+            unsigned long v = strtoul(argv[++i], NULL, 0);
+            switch (a[1]) {
+            case 'k':
+                k = v;
+                break;
+            case 'm':
+                m = v;
+                break;
+            case 'c':
+                chunkSize = v;
+                break;
+            case 't':
+                threadCount = v;
+                break;
+            default:
+                usage();
+                return 2;
+            }
+        } else {
+            args.push_back(a);
+        }
+    }
+    string cmd = argv[1];
+    if (cmd == "encode" && args.size() == 2) {
+        if (k < 1 || m < 1 || k + m > GF28Value::limit() || chunkSize == 0
+                || chunkSize % RSfile::HEADER_SIZE != 0) {
+            cerr << "invalid k, m or chunk size (a multiple of "
+                    << RSfile::HEADER_SIZE << ")" << endl;
+            return 2;
+        }
+        return encodeFile(args[0], args[1], k, m, chunkSize, threadCount);
+    } else if (cmd == "decode" && args.size() == 2) {
+        return decodeFile(args[0], args[1], threadCount);
+    }
+    usage();
+    return 2;
+}
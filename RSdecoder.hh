@@ -0,0 +1,291 @@
+/*
+ * RSdecoder.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSDECODER_HH_
+#define RSDECODER_HH_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "RScode.hh"
+
+/* Progressive decoding of one stripe: shards are added as they arrive
+ * (from the network, from disks of different speeds) and each one is
+ * eliminated on arrival, so the stripe is decoded when the k-th independent
+ * shard has been added, with no decoding pass after it.
+ * Data shards are used in place and must stay valid until the lines have
+ * been read. Every FEC shard is read once, into a work buffer which holds
+ *   W_f = sum of c_f[j] x d_j over the data lines j not received yet,
+ * with the coefficients c_f kept reduced (Gauss-Jordan): c_f[p_f] = 1 and
+ * c_g[p_f] = 0 for the other rows g. A data shard j clears column j of
+ * the rows, a FEC shard is reduced against the received data and the rows,
+ * then cleared from the other rows. Once the rank is k, W_f is d_{p_f}.
+ * The work of an arrival is bounded by one region pass per pending row.
+ * The buffers and coefficients are sized for k rows by the constructor and
+ * kept by reset(), so a decoder is reused for the stripes of an object and
+ * an arrival allocates nothing but a work buffer the first time one more
+ * is needed.
+ *  */
+template<typename T>
+class RSdecoder {
+public:
+    typedef typename RScode<T>::E_RSCODE_STS E_RSCODE_STS;
+    typedef typename RScode<T>::SYMBOL SYMBOL;
+
+public:
+    RSdecoder(const RScode<T> &code, size_t shardSize) :
+            m_code(code), m_shardSize(shardSize),
+            m_k(code.encodeLineSize()) {
+        m_rows.reserve(m_k);
+        m_rowCoef.assign(m_k * m_k, T(0));
+        m_c.assign(m_k, T(0));
+        m_a.assign(m_k, T(0));
+        m_src.reserve(2 * m_k + 1);
+        m_coef.reserve(2 * m_k + 1);
+        m_symbol.reserve(2 * m_k + 1);
+        reset();
+    }
+    ~RSdecoder() {
+    }
+    RSdecoder(const RSdecoder &) = delete;
+    RSdecoder& operator=(const RSdecoder &) = delete;
+
+    /* Start a new stripe, the work buffers are kept */
+    void reset(void) {
+        for (size_t f = 0; f < m_rows.size(); ++f) {
+            m_free.push_back(m_rows[f].m_buffer);
+        }
+        m_rows.clear();
+        m_data.assign(m_k, NULL);
+        m_pivot.assign(m_k, NONE);
+        m_dataCount = 0;
+    }
+
+    /* Independent shards added */
+    inline unsigned int rank(void) const {
+        return m_dataCount + m_rows.size();
+    }
+    inline bool complete(void) const {
+        return rank() == m_k;
+    }
+    /* Data line i once complete(), NULL before */
+    inline const unsigned char* line(unsigned int i) const {
+        if (!complete() || i >= m_k) {
+            return NULL;
+        }
+        return (m_data[i] != NULL) ? m_data[i] : m_rows[m_pivot[i]].m_buffer;
+    }
+
+    /* Add row index of the encoding matrix, shardSize bytes.
+     * A shard which adds nothing to the ones before (a duplicate or a
+     * dependent row) returns e_rscode_sts_singular_err; shards added after
+     * completion are ignored.
+     *  */
+    E_RSCODE_STS add(unsigned int index, const unsigned char *shard) {
+        if (m_code.state() != RScode<T>::e_rscode_sts_ok) {
+            return m_code.state();
+        }
+        if (m_shardSize == 0 || m_shardSize % RScode<T>::SYMBOL_SIZE != 0) {
+            return RScode<T>::e_rscode_sts_size_err;
+        }
+        if (index >= m_code.limit()) {
+            return RScode<T>::e_rscode_sts_index_err;
+        }
+        if (complete()) {
+            return RScode<T>::e_rscode_sts_ok;
+        }
+        return (index < m_k) ? addData(index, shard) : addParity(index, shard);
+    }
+
+private:
+    enum { NONE = ~0u };                /* No pivot */
+
+    /* Pending FEC row, its coefficients c_f are row(f) */
+    struct Row {
+        unsigned int m_pivot;
+        unsigned char *m_buffer;        /* W_f */
+    };
+
+    static inline SYMBOL symbol(const T &t) {
+        return (SYMBOL) t.value();
+    }
+    inline T* row(unsigned int f) {
+        return &m_rowCoef[f * m_k];
+    }
+    unsigned char* buffer(void) {
+        if (m_free.empty()) {
+            m_buffers.emplace_back(new unsigned char[m_shardSize]);
+            RSstats::add(RSstats::e_rs_stat_allocations);
+            RSstats::add(RSstats::e_rs_stat_allocated_bytes, m_shardSize);
+            return m_buffers.back().get();
+        }
+        unsigned char *p = m_free.back();
+        m_free.pop_back();
+        return p;
+    }
+    /* Clear column p of the rows other than f, whose pivot is p */
+    void eliminate(unsigned int f) {
+        const Row &r = m_rows[f];
+        const T *rc = row(f);
+        for (unsigned int g = 0; g < m_rows.size(); ++g) {
+            T *oc = row(g);
+            const T a = oc[r.m_pivot];
+            if (g == f || a == T(0)) {
+                continue;
+            }
+            T::Region::multiplyAdd(m_rows[g].m_buffer, r.m_buffer, symbol(a), m_shardSize);
+            for (unsigned int j = 0; j < m_k; ++j) {
+                oc[j] = oc[j] - a * rc[j];
+            }
+        }
+    }
+    /* First nonzero coefficient of c, NONE if it has none */
+    unsigned int pivot(const T *c) const {
+        for (unsigned int j = 0; j < m_k; ++j) {
+            if (c[j] != T(0)) {
+                return j;
+            }
+        }
+        return NONE;
+    }
+    E_RSCODE_STS addData(unsigned int j, const unsigned char *shard) {
+        if (m_data[j] != NULL) {
+            return RScode<T>::e_rscode_sts_singular_err;
+        }
+        const unsigned int f = m_pivot[j];
+        if (f == NONE) {
+            /* Independent of the rows, which have no pivot j */
+            for (unsigned int g = 0; g < m_rows.size(); ++g) {
+                T *oc = row(g);
+                if (oc[j] != T(0)) {
+                    T::Region::multiplyAdd(m_rows[g].m_buffer, shard, symbol(oc[j]), m_shardSize);
+                    oc[j] = T(0);
+                }
+            }
+            m_data[j] = shard;
+            ++m_dataCount;
+            return RScode<T>::e_rscode_sts_ok;
+        }
+        /* Row f (c_f[j] = 1) moves to another pivot, or goes if d_j was
+         * all it had left */
+        m_pivot[j] = NONE;
+        Row &r = m_rows[f];
+        T *rc = row(f);
+        rc[j] = T(0);
+        const unsigned int p = pivot(rc);
+        if (p == NONE) {
+            /* d_j replaces W_f, the rank is the same */
+            removeRow(f);
+            m_data[j] = shard;
+            ++m_dataCount;
+            return RScode<T>::e_rscode_sts_singular_err;
+        }
+        const T inv = T(1) / rc[p];
+        const unsigned char *src[2] = { r.m_buffer, shard };
+        const SYMBOL coef[2] = { symbol(inv), symbol(inv) };
+        unsigned char *w = buffer();
+        T::Region::dotProduct(w, src, 0, coef, 2, m_shardSize);
+        m_free.push_back(r.m_buffer);
+        r.m_buffer = w;
+        for (unsigned int i = 0; i < m_k; ++i) {
+            rc[i] = rc[i] * inv;
+        }
+        r.m_pivot = p;
+        m_pivot[p] = f;
+        eliminate(f);
+        m_data[j] = shard;
+        ++m_dataCount;
+        /* The other rows had no column j */
+        return RScode<T>::e_rscode_sts_ok;
+    }
+    E_RSCODE_STS addParity(unsigned int index, const unsigned char *shard) {
+        T *c = m_c.data();
+        for (unsigned int j = 0; j < m_k; ++j) {
+            c[j] = m_code.coefficient(index, j);
+        }
+        /* y - sum c[j] x d_j (received j) - sum c[p_f] x W_f is the
+         * combination of the other lines, the coefficients of the rows are
+         * those of c before any of them is subtracted as c_f[p_g] = 0 */
+        m_src.clear();
+        m_coef.clear();
+        m_src.push_back(shard);
+        m_coef.push_back(T(1));
+        for (unsigned int j = 0; j < m_k; ++j) {
+            if (m_data[j] != NULL && c[j] != T(0)) {
+                m_src.push_back(m_data[j]);
+                m_coef.push_back(c[j]);
+                c[j] = T(0);
+            }
+        }
+        const size_t rowCount = m_rows.size();
+        T *a = m_a.data();
+        for (unsigned int f = 0; f < rowCount; ++f) {
+            a[f] = c[m_rows[f].m_pivot];
+        }
+        for (unsigned int f = 0; f < rowCount; ++f) {
+            if (a[f] == T(0)) {
+                continue;
+            }
+            const T *rc = row(f);
+            for (unsigned int j = 0; j < m_k; ++j) {
+                c[j] = c[j] - a[f] * rc[j];
+            }
+            m_src.push_back(m_rows[f].m_buffer);
+            m_coef.push_back(a[f]);
+        }
+        const unsigned int p = pivot(c);
+        if (p == NONE) {
+            return RScode<T>::e_rscode_sts_singular_err;
+        }
+        const T inv = T(1) / c[p];
+        for (unsigned int j = 0; j < m_k; ++j) {
+            c[j] = c[j] * inv;
+        }
+        m_symbol.resize(m_coef.size());
+        for (size_t i = 0; i < m_coef.size(); ++i) {
+            m_symbol[i] = symbol(m_coef[i] * inv);
+        }
+        Row r;
+        r.m_pivot = p;
+        r.m_buffer = buffer();
+        T::Region::dotProduct(r.m_buffer, m_src.data(), 0, m_symbol.data(),
+                m_src.size(), m_shardSize);
+        std::copy(c, c + m_k, row(rowCount));
+        m_rows.push_back(r);
+        m_pivot[p] = m_rows.size() - 1;
+        eliminate(m_rows.size() - 1);
+        return RScode<T>::e_rscode_sts_ok;
+    }
+    void removeRow(unsigned int f) {
+        m_free.push_back(m_rows[f].m_buffer);
+        if (f + 1 != m_rows.size()) {
+            m_rows[f] = m_rows.back();
+            std::copy(row(m_rows.size() - 1), row(m_rows.size() - 1) + m_k, row(f));
+            m_pivot[m_rows[f].m_pivot] = f;
+        }
+        m_rows.pop_back();
+    }
+
+private:
+    const RScode<T> &m_code;
+    const size_t m_shardSize;
+    const unsigned int m_k;
+    std::vector<const unsigned char*> m_data;       /* Received data shards */
+    std::vector<unsigned int> m_pivot;              /* Row of a pivot column */
+    unsigned int m_dataCount;
+    std::vector<Row> m_rows;
+    std::vector<T> m_rowCoef;                       /* k x k, c_f of row f */
+    std::vector<T> m_c;                             /* c of an arriving FEC shard */
+    std::vector<T> m_a;                             /* Its c[p_f] */
+    std::vector<std::unique_ptr<unsigned char[]>> m_buffers;
+    std::vector<unsigned char*> m_free;             /* Unused buffers */
+    std::vector<const unsigned char*> m_src;        /* Sources of an arrival */
+    std::vector<T> m_coef;
+    std::vector<SYMBOL> m_symbol;
+};
+
+#endif /* RSDECODER_HH_ */
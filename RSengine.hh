@@ -0,0 +1,192 @@
+/*
+ * RSengine.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSENGINE_HH_
+#define RSENGINE_HH_
+
+#include <vector>
+#include <atomic>
+
+#include "RScode.hh"
+#include "ThreadPool.hh"
+
+/* Multi-threaded encoding/decoding with the same synchronous interface as
+ * RScode.
+ * Shards are split along the columns into slices, and the slices of one
+ * stripe or of a batch of stripes are spread over a work-stealing pool.
+ * The RScode object is shared by the workers through its const methods,
+ * and can be shared with other engines and threads as well. The decoding
+ * methods keep their scratch space in a Context of the caller, so an
+ * engine can be shared by threads too.
+ *  */
+template<typename T>
+class RSengine {
+public:
+    typedef typename RScode<T>::Shard Shard;
+    typedef typename RScode<T>::E_RSCODE_STS E_RSCODE_STS;
+    typedef typename RScode<T>::Context Context;
+
+public:
+    /* threadCount 0 means one thread per hardware thread */
+    RSengine(const RScode<T> &code, unsigned int threadCount = 0,
+            size_t sliceSize = SLICE_SIZE) :
+            m_code(code), m_pool(threadCount) {
+        setSliceSize(sliceSize);
+    }
+    ~RSengine() {
+    }
+    RSengine(const RSengine &) = delete;
+    RSengine& operator=(const RSengine &) = delete;
+
+    inline unsigned int threadCount(void) const {
+        return m_pool.size();
+    }
+    /* Columns of a shard processed by one task (rounded up to 64 bytes) */
+    void setSliceSize(size_t sliceSize) {
+        m_sliceSize = (sliceSize + 63) / 64 * 64;
+        if (m_sliceSize == 0) {
+            m_sliceSize = SLICE_SIZE;
+        }
+    }
+    inline size_t sliceSize(void) const {
+        return m_sliceSize;
+    }
+
+    /* Same as RScode::encodeStripe */
+    E_RSCODE_STS encodeStripe(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize) {
+        return encodeStripes(&data, &parity, 1, parityCount, shardSize);
+    }
+    /* Encode stripeCount stripes, data[s] and parity[s] are the shards of
+     * stripe s as in RScode::encodeStripe */
+    E_RSCODE_STS encodeStripes(const unsigned char * const * const *data,
+            unsigned char * const * const *parity, unsigned int stripeCount,
+            unsigned int parityCount, size_t shardSize) {
+        const size_t slices = sliceCount(shardSize);
+        std::atomic<int> sts(RScode<T>::e_rscode_sts_ok);
+        /* One pass for RSstats, timed over all the slices */
+        RSstats::Scope scope(RSstats::e_rs_trace_encode,
+                stripeCount * m_code.encodeLineSize() * shardSize);
+        m_pool.parallelFor(stripeCount * slices, [&](size_t t) {
+            size_t offset = (t % slices) * m_sliceSize;
+            E_RSCODE_STS s = m_code.encodeStripe(data[t / slices],
+                    parity[t / slices], parityCount, offset,
+                    sliceLength(offset, shardSize));
+            if (s != RScode<T>::e_rscode_sts_ok) {
+                sts = s;
+            }
+        });
+        return (E_RSCODE_STS) sts.load();
+    }
+    /* Same as the scatter/gather RScode::decode, with a Context of the
+     * call */
+    E_RSCODE_STS decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize) {
+        Context ctx;
+        return decode(shards, shardCount, data, shardSize, ctx);
+    }
+    /* Any number of threads can decode with one engine, each with its own
+     * Context, as with RScode's const methods */
+    E_RSCODE_STS decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize, Context &ctx) {
+        if (shardSize == 0 || shardSize % RScode<T>::SYMBOL_SIZE != 0) {
+            return status(ctx, RScode<T>::e_rscode_sts_size_err);
+        }
+        m_code.reserve(ctx);
+        const typename RScode<T>::DecodePlan *plan = m_code.selectShards(shards,
+                shardCount, ctx.m_src.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        for (unsigned int i = 0; i < plan->m_missing.size(); ++i) {
+            if (data[plan->m_missing[i]] == NULL) {
+                return status(ctx, RScode<T>::e_rscode_sts_output_err);
+            }
+            ctx.m_dst[i] = data[plan->m_missing[i]];
+        }
+        RSstats::Scope scope(RSstats::e_rs_trace_decode,
+                plan->m_missing.size() * shardSize);
+        m_pool.parallelFor(sliceCount(shardSize), [&](size_t t) {
+            size_t offset = t * m_sliceSize;
+            m_code.applyPlan(*plan, ctx.m_src.data(), ctx.m_dst.data(), offset,
+                    sliceLength(offset, shardSize));
+        });
+        return status(ctx, RScode<T>::e_rscode_sts_ok);
+    }
+    /* Same as RScode::decodeStripes, the slices of all the stripes are
+     * spread over the pool */
+    E_RSCODE_STS decodeStripes(const unsigned int *indices,
+            unsigned int shardCount, const unsigned char * const * const *shards,
+            unsigned char * const * const *data, unsigned int stripeCount,
+            size_t shardSize) {
+        Context ctx;
+        return decodeStripes(indices, shardCount, shards, data, stripeCount,
+                shardSize, ctx);
+    }
+    /* The rows of every stripe are kept in ctx for the next batch */
+    E_RSCODE_STS decodeStripes(const unsigned int *indices,
+            unsigned int shardCount, const unsigned char * const * const *shards,
+            unsigned char * const * const *data, unsigned int stripeCount,
+            size_t shardSize, Context &ctx) {
+        if (shardSize == 0 || shardSize % RScode<T>::SYMBOL_SIZE != 0) {
+            return status(ctx, RScode<T>::e_rscode_sts_size_err);
+        }
+        m_code.reserve(ctx);
+        const typename RScode<T>::DecodePlan *plan = m_code.selectShards(indices,
+                shardCount, ctx.m_pick.data(), ctx);
+        if (!plan) {
+            return ctx.m_error;
+        }
+        const unsigned int k = m_code.encodeLineSize();
+        const unsigned int n = plan->m_missing.size();
+        std::vector<const unsigned char*> &src = ctx.m_src;
+        std::vector<unsigned char*> &dst = ctx.m_dst;
+        src.resize(stripeCount * k);
+        dst.resize(stripeCount * n);
+        for (unsigned int s = 0; s < stripeCount; ++s) {
+            for (unsigned int j = 0; j < k; ++j) {
+                src[s * k + j] = shards[s][ctx.m_pick[j]];
+            }
+            for (unsigned int i = 0; i < n; ++i) {
+                dst[s * n + i] = data[s][plan->m_missing[i]];
+                if (dst[s * n + i] == NULL) {
+                    return status(ctx, RScode<T>::e_rscode_sts_output_err);
+                }
+            }
+        }
+        const size_t slices = sliceCount(shardSize);
+        RSstats::Scope scope(RSstats::e_rs_trace_decode,
+                stripeCount * n * shardSize);
+        m_pool.parallelFor(stripeCount * slices, [&](size_t t) {
+            size_t s = t / slices;
+            size_t offset = (t % slices) * m_sliceSize;
+            m_code.applyPlan(*plan, &src[s * k], &dst[s * n], offset,
+                    sliceLength(offset, shardSize));
+        });
+        return status(ctx, RScode<T>::e_rscode_sts_ok);
+    }
+
+private:
+    inline E_RSCODE_STS status(Context &ctx, E_RSCODE_STS sts) const {
+        ctx.m_error = sts;
+        return sts;
+    }
+    inline size_t sliceCount(size_t shardSize) const {
+        return (shardSize + m_sliceSize - 1) / m_sliceSize;
+    }
+    inline size_t sliceLength(size_t offset, size_t shardSize) const {
+        return (shardSize - offset < m_sliceSize) ? shardSize - offset : m_sliceSize;
+    }
+
+private:
+    static const size_t SLICE_SIZE = 65536;     /* Default slice of a shard */
+    const RScode<T> &m_code;
+    ThreadPool m_pool;
+    size_t m_sliceSize;
+};
+
+#endif /* RSENGINE_HH_ */
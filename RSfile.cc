@@ -0,0 +1,324 @@
+/*
+ * RSfile.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Crc32c.hh"
+#include "RSfile.hh"
+
+using namespace std;
+
+typedef RSfile::RS RS;
+
+const char RSfile::MAGIC[8] = { 'R', 'S', 'S', 'H', 'A', 'R', 'D', '2' };
+
+static_assert(sizeof(RSfile::Header) == 72, "RSfile::Header must have no padding");
+
+static string shardName(const string &prefix, unsigned int index) {
+    return prefix + "." + to_string(index);
+}
+
+static uint32_t headerCrc(const RSfile::Header &h) {
+    return Crc32c::extend(0, (const unsigned char *) &h,
+            offsetof(RSfile::Header, m_headerCrc));
+}
+
+static bool writeAll(int fd, const unsigned char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+RSfile::RSfile() :
+        m_index(NULL) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+RSfile::~RSfile() {
+    close();
+}
+
+/* A file is valid if its header and index check and its size is the one
+ * the header gives */
+RSfile::E_RSCODE_STS RSfile::open(const string &prefix) {
+    close();
+    bool found = false;
+    int error = ENOENT;                 /* Of the last file not opened */
+    for (unsigned int i = 0; i < GF28Value::limit() && (!found || i < m_header.m_k + m_header.m_m); ++i) {
+        string name = shardName(prefix, i);
+        int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno != ENOENT) {
+                error = errno;
+            }
+            continue;
+        }
+        Header h;
+        struct stat st;
+        bool ok = pread(fd, &h, sizeof(h), 0) == (ssize_t) sizeof(h)
+                && memcmp(h.m_magic, MAGIC, sizeof(MAGIC)) == 0
+                && h.m_version == VERSION && h.m_fieldBits == 8
+                && h.m_headerCrc == headerCrc(h) && h.m_index == i
+                && h.m_k >= 1 && h.m_k + h.m_m <= GF28Value::limit()
+                && h.m_chunkSize > 0 && h.m_chunkSize % HEADER_SIZE == 0
+                && h.m_indexOffset == HEADER_SIZE + h.m_stripeCount * h.m_chunkSize
+                && fstat(fd, &st) == 0
+                && (uint64_t) st.st_size == h.m_indexOffset
+                        + h.m_stripeCount * (h.m_k + h.m_m) * sizeof(uint32_t);
+        if (ok && found) {
+            ok = h.m_k == m_header.m_k && h.m_m == m_header.m_m
+                    && h.m_chunkSize == m_header.m_chunkSize
+                    && h.m_objectSize == m_header.m_objectSize
+                    && h.m_stripeCount == m_header.m_stripeCount
+                    && h.m_indexCrc == m_header.m_indexCrc;
+        }
+        void *p = MAP_FAILED;
+        if (ok) {
+            p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                error = errno;
+            }
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            continue;
+        }
+        const unsigned char *map = (const unsigned char *) p;
+        const uint32_t *index = (const uint32_t *) (map + h.m_indexOffset);
+        if (Crc32c::extend(0, (const unsigned char *) index,
+                st.st_size - h.m_indexOffset) != h.m_indexCrc) {
+            munmap(p, st.st_size);
+            continue;
+        }
+        if (!found) {
+            m_header = h;
+            m_map.assign(h.m_k + h.m_m, NULL);
+            m_mapSize.assign(h.m_k + h.m_m, 0);
+            m_index = index;
+            found = true;
+        }
+        m_map[i] = map;
+        m_mapSize[i] = st.st_size;
+    }
+    unsigned int count = 0;
+    for (size_t i = 0; i < m_map.size(); ++i) {
+        count += m_map[i] != NULL;
+    }
+    if (!found || count < m_header.m_k) {
+        close();
+        errno = error;
+        return found ? RS::e_rscode_sts_shards_err : RS::e_rscode_sts_io_err;
+    }
+    const size_t chunks = m_header.m_stripeCount * m_map.size();
+    m_chunkState.reset(new atomic<unsigned char>[chunks]);
+    for (size_t c = 0; c < chunks; ++c) {
+        m_chunkState[c].store((m_map[c % m_map.size()] != NULL) ? CHUNK_UNKNOWN : CHUNK_BAD,
+                memory_order_relaxed);
+    }
+    m_pCode.reset(new RS(m_header.m_k, 1, m_header.m_k + m_header.m_m));
+    return RS::e_rscode_sts_ok;
+}
+
+void RSfile::close(void) {
+    for (size_t i = 0; i < m_map.size(); ++i) {
+        if (m_map[i] != NULL) {
+            munmap((void *) m_map[i], m_mapSize[i]);
+        }
+    }
+    m_map.clear();
+    m_mapSize.clear();
+    m_index = NULL;
+    m_chunkState.reset();
+    m_pCode.reset();
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+bool RSfile::verify(uint64_t stripe, unsigned int shard) const {
+    atomic<unsigned char> &state = m_chunkState[stripe * m_map.size() + shard];
+    unsigned char s = state.load(memory_order_relaxed);
+    if (s == CHUNK_UNKNOWN) {
+        const unsigned char *p = chunk(stripe, shard);
+        s = (Crc32c::extend(0, p, m_header.m_chunkSize) == checksum(stripe, shard))
+                ? CHUNK_GOOD : CHUNK_BAD;
+        state.store(s, memory_order_relaxed);
+    }
+    return s == CHUNK_GOOD;
+}
+
+const unsigned char* RSfile::slice(uint64_t pos, size_t len) const {
+    if (len == 0 || pos > m_header.m_objectSize
+            || len > m_header.m_objectSize - pos) {
+        return NULL;
+    }
+    const Location l = locate(pos);
+    if (l.m_offset + len > m_header.m_chunkSize) {
+        return NULL;
+    }
+    const unsigned char *p = chunk(l.m_stripe, l.m_shard);
+    return (p == NULL) ? NULL : p + l.m_offset;
+}
+
+RSfile::E_RSCODE_STS RSfile::read(uint64_t pos, size_t len, unsigned char *buf,
+        RS::Context &ctx) const {
+    if (!m_pCode) {
+        return RS::e_rscode_sts_init;
+    }
+    if (pos > m_header.m_objectSize || len > m_header.m_objectSize - pos) {
+        return RS::e_rscode_sts_size_err;
+    }
+    const unsigned int n = m_header.m_k + m_header.m_m;
+    vector<RS::Shard> shards;           /* Only for missing shards */
+    vector<unsigned int> unknown;
+    while (len > 0) {
+        const Location l = locate(pos);
+        size_t piece = m_header.m_chunkSize - l.m_offset;
+        if (piece > len) {
+            piece = len;
+        }
+        if (verify(l.m_stripe, l.m_shard)) {
+            memcpy(buf, chunk(l.m_stripe, l.m_shard) + l.m_offset, piece);
+        } else {
+            /* k chunks which match their checksums, the ones already
+             * verified first so that no other chunk is hashed */
+            shards.clear();
+            unknown.clear();
+            const atomic<unsigned char> *state = &m_chunkState[l.m_stripe * n];
+            for (unsigned int i = 0; i < n && shards.size() < m_header.m_k; ++i) {
+                const unsigned char s = state[i].load(memory_order_relaxed);
+                if (s == CHUNK_GOOD) {
+                    RS::Shard shard;
+                    shard.index = i;
+                    shard.data = chunk(l.m_stripe, i);
+                    shards.push_back(shard);
+                } else if (s == CHUNK_UNKNOWN) {
+                    unknown.push_back(i);
+                }
+            }
+            for (size_t u = 0; u < unknown.size() && shards.size() < m_header.m_k; ++u) {
+                if (verify(l.m_stripe, unknown[u])) {
+                    RS::Shard shard;
+                    shard.index = unknown[u];
+                    shard.data = chunk(l.m_stripe, unknown[u]);
+                    shards.push_back(shard);
+                }
+            }
+            if (shards.size() < m_header.m_k) {
+                return RS::e_rscode_sts_corrupt_err;
+            }
+            E_RSCODE_STS sts = m_pCode->decodeRange(shards.data(),
+                    shards.size(), l.m_shard, buf, l.m_offset, piece, ctx);
+            if (sts != RS::e_rscode_sts_ok) {
+                return sts;
+            }
+        }
+        pos += piece;
+        buf += piece;
+        len -= piece;
+    }
+    return RS::e_rscode_sts_ok;
+}
+
+RSfileWriter::RSfileWriter() {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+RSfileWriter::~RSfileWriter() {
+    close();
+}
+
+RSfileWriter::E_RSCODE_STS RSfileWriter::create(const string &prefix,
+        unsigned int k, unsigned int m, size_t chunkSize) {
+    close();
+    if (k < 1 || k + m > GF28Value::limit() || chunkSize == 0
+            || chunkSize % RSfile::HEADER_SIZE != 0) {
+        return RS::e_rscode_sts_construct_err;
+    }
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.m_magic, RSfile::MAGIC, sizeof(RSfile::MAGIC));
+    m_header.m_version = RSfile::VERSION;
+    m_header.m_fieldBits = 8;
+    m_header.m_k = k;
+    m_header.m_m = m;
+    m_header.m_chunkSize = chunkSize;
+    m_index.clear();
+    for (unsigned int i = 0; i < k + m; ++i) {
+        int fd = ::open(shardName(prefix, i).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            close();
+            return RS::e_rscode_sts_io_err;
+        }
+        m_fd.push_back(fd);
+        if (lseek(fd, RSfile::HEADER_SIZE, SEEK_SET) < 0) {
+            close();
+            return RS::e_rscode_sts_io_err;
+        }
+    }
+    return RS::e_rscode_sts_ok;
+}
+
+RSfileWriter::E_RSCODE_STS RSfileWriter::append(const unsigned char * const *chunks,
+        const uint32_t *crc) {
+    if (m_fd.empty()) {
+        return RS::e_rscode_sts_init;
+    }
+    for (size_t i = 0; i < m_fd.size(); ++i) {
+        if (!writeAll(m_fd[i], chunks[i], m_header.m_chunkSize)) {
+            return RS::e_rscode_sts_io_err;
+        }
+    }
+    m_index.insert(m_index.end(), crc, crc + m_fd.size());
+    ++m_header.m_stripeCount;
+    return RS::e_rscode_sts_ok;
+}
+
+RSfileWriter::E_RSCODE_STS RSfileWriter::finish(uint64_t objectSize) {
+    if (m_fd.empty()) {
+        return RS::e_rscode_sts_init;
+    }
+    const unsigned char *index = (const unsigned char *) m_index.data();
+    const size_t indexSize = m_index.size() * sizeof(uint32_t);
+    m_header.m_objectSize = objectSize;
+    m_header.m_indexOffset = RSfile::HEADER_SIZE
+            + m_header.m_stripeCount * m_header.m_chunkSize;
+    m_header.m_indexCrc = Crc32c::extend(0, index, indexSize);
+    E_RSCODE_STS sts = RS::e_rscode_sts_ok;
+    unsigned char page[RSfile::HEADER_SIZE];
+    for (size_t i = 0; i < m_fd.size() && sts == RS::e_rscode_sts_ok; ++i) {
+        RSfile::Header h = m_header;
+        h.m_index = i;
+        h.m_headerCrc = headerCrc(h);
+        memset(page, 0, sizeof(page));
+        memcpy(page, &h, sizeof(h));
+        if (!writeAll(m_fd[i], index, indexSize)
+                || pwrite(m_fd[i], page, sizeof(page), 0) != (ssize_t) sizeof(page)) {
+            sts = RS::e_rscode_sts_io_err;
+        }
+    }
+    close();
+    return sts;
+}
+
+void RSfileWriter::close(void) {
+    for (size_t i = 0; i < m_fd.size(); ++i) {
+        ::close(m_fd[i]);
+    }
+    m_fd.clear();
+}
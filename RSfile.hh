@@ -0,0 +1,176 @@
+/*
+ * RSfile.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSFILE_HH_
+#define RSFILE_HH_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "GF28Value.hh"
+#include "RScode.hh"
+
+/* Container of an erasure coded object: one file per shard, <prefix>.i
+ * (0 <= i < k + m). Each file is
+ *   header       HEADER_SIZE bytes (Header, then zeros)
+ *   chunks       stripeCount x chunkSize bytes, chunk s at
+ *                HEADER_SIZE + s x chunkSize
+ *   stripe index stripeCount x (k + m) CRC-32C of the chunks of every
+ *                shard, at indexOffset
+ * Byte b of the object is at offset b % chunkSize of chunk
+ * b / (k x chunkSize) of data shard (b / chunkSize) % k, so a range maps
+ * to its chunks without reading anything, and every field is at a fixed
+ * offset: a mapped file is used as it is, with no parsing pass.
+ * Integers are little endian (the byte order of the supported hosts).
+ * Every file holds the whole index, so any k files describe the object.
+ *  */
+class RSfile {
+public:
+    typedef RScode<GF28Value> RS;
+    typedef RS::E_RSCODE_STS E_RSCODE_STS;
+    /* Chunk sizes are multiples of HEADER_SIZE, so the chunks and the
+     * index are page aligned */
+    static const size_t HEADER_SIZE = 4096;
+    static const uint32_t VERSION = 1;
+    static const char MAGIC[8];
+
+    struct Header {
+        char m_magic[8];                /* MAGIC */
+        uint32_t m_version;             /* VERSION */
+        uint32_t m_fieldBits;           /* 8: GF(2^8) */
+        uint32_t m_k;                   /* Data shards */
+        uint32_t m_m;                   /* FEC shards */
+        uint32_t m_index;               /* Shard of this file */
+        uint32_t m_indexCrc;            /* CRC-32C of the stripe index */
+        uint64_t m_chunkSize;           /* Bytes of a shard per stripe */
+        uint64_t m_objectSize;          /* Bytes of the object */
+        uint64_t m_stripeCount;
+        uint64_t m_indexOffset;         /* Offset of the stripe index */
+        uint32_t m_reserved;
+        uint32_t m_headerCrc;           /* CRC-32C of the fields before */
+    };
+    /* Position of an object byte */
+    struct Location {
+        uint64_t m_stripe;
+        unsigned int m_shard;           /* Data shard */
+        size_t m_offset;                /* In the chunk */
+    };
+
+public:
+    RSfile();
+    ~RSfile();
+    RSfile(const RSfile &) = delete;
+    RSfile& operator=(const RSfile &) = delete;
+
+    /* Map the valid shard files of prefix, which must be at least k.
+     * Files with a bad header or index, or which disagree with the first
+     * valid one, are left out (present() is false).
+     * On failure errno is the error of the last file which could not be
+     * opened or mapped, ENOENT if the files are only missing or invalid.
+     *  */
+    E_RSCODE_STS open(const std::string &prefix);
+    void close(void);
+
+    inline unsigned int k(void) const {return m_header.m_k;};
+    inline unsigned int m(void) const {return m_header.m_m;};
+    inline size_t chunkSize(void) const {return m_header.m_chunkSize;};
+    inline uint64_t objectSize(void) const {return m_header.m_objectSize;};
+    inline uint64_t stripeCount(void) const {return m_header.m_stripeCount;};
+    inline const RS& code(void) const {return *m_pCode;};
+
+    inline Location locate(uint64_t pos) const {
+        const uint64_t chunk = pos / m_header.m_chunkSize;
+        Location l;
+        l.m_stripe = chunk / m_header.m_k;
+        l.m_shard = chunk % m_header.m_k;
+        l.m_offset = pos % m_header.m_chunkSize;
+        return l;
+    }
+    inline bool present(unsigned int shard) const {
+        return m_map[shard] != NULL;
+    }
+    /* Chunk of shard in stripe, in the mapping (NULL if the file is missing) */
+    inline const unsigned char* chunk(uint64_t stripe, unsigned int shard) const {
+        if (m_map[shard] == NULL) {
+            return NULL;
+        }
+        return m_map[shard] + HEADER_SIZE + stripe * m_header.m_chunkSize;
+    }
+    inline uint32_t checksum(uint64_t stripe, unsigned int shard) const {
+        return m_index[stripe * (m_header.m_k + m_header.m_m) + shard];
+    }
+    /* The chunk is present and matches its checksum. A chunk is hashed
+     * once per open(), the result is kept for the later calls */
+    bool verify(uint64_t stripe, unsigned int shard) const;
+
+    /* Zero-copy read: [pos, pos + len) of the object in the mapping, NULL
+     * if the range crosses a chunk or its shard is missing */
+    const unsigned char* slice(uint64_t pos, size_t len) const;
+    /* Copy [pos, pos + len) of the object into buf. A chunk is read only if
+     * it matches its checksum; ranges of missing or damaged chunks are
+     * decoded from the same columns of k chunks which match theirs, or
+     * e_rscode_sts_corrupt_err is returned if there are not k of them.
+     * Only the requested columns of the chunks used are read, except for
+     * the first use of a chunk, which verify() hashes whole. */
+    E_RSCODE_STS read(uint64_t pos, size_t len, unsigned char *buf,
+            RS::Context &ctx) const;
+
+private:
+    enum {
+        CHUNK_UNKNOWN = 0,              /* Not hashed yet */
+        CHUNK_GOOD,
+        CHUNK_BAD,                      /* Missing or damaged */
+    };
+
+private:
+    Header m_header;
+    std::vector<const unsigned char*> m_map;    /* Mapped file of every shard */
+    std::vector<size_t> m_mapSize;
+    const uint32_t *m_index;                    /* Stripe index of a mapped file */
+    /* CHUNK_* of every chunk, in the order of the index. Readers on
+     * several threads may hash a chunk at the same time, they store the
+     * same result */
+    std::unique_ptr<std::atomic<unsigned char>[]> m_chunkState;
+    std::unique_ptr<RS> m_pCode;
+};
+
+/* Writes the shard files of RSfile stripe by stripe: the chunks are
+ * appended as they come and the index and headers are written by finish(),
+ * so the object size need not be known in advance.
+ *  */
+class RSfileWriter {
+public:
+    typedef RSfile::E_RSCODE_STS E_RSCODE_STS;
+
+public:
+    RSfileWriter();
+    ~RSfileWriter();
+    RSfileWriter(const RSfileWriter &) = delete;
+    RSfileWriter& operator=(const RSfileWriter &) = delete;
+
+    /* Create (truncate) <prefix>.0 ... <prefix>.(k+m-1), chunkSize is a
+     * multiple of RSfile::HEADER_SIZE */
+    E_RSCODE_STS create(const std::string &prefix, unsigned int k,
+            unsigned int m, size_t chunkSize);
+    /* chunks[0..k+m-1] are the chunks of the next stripe, crc[] their
+     * CRC-32C (as returned by RScode::encodeStripeCrc) */
+    E_RSCODE_STS append(const unsigned char * const *chunks, const uint32_t *crc);
+    /* Write the index and the headers and close the files */
+    E_RSCODE_STS finish(uint64_t objectSize);
+
+private:
+    void close(void);
+
+private:
+    RSfile::Header m_header;
+    std::vector<int> m_fd;
+    std::vector<uint32_t> m_index;
+};
+
+#endif /* RSFILE_HH_ */
@@ -0,0 +1,273 @@
+/*
+ * RSlrcCode.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include "GF28Region.hh"
+#include "RSlrcCode.hh"
+
+using namespace std;
+
+typedef RScode<GF28Value> RS;
+
+RSlrcCode::RSlrcCode(unsigned int dataCount, unsigned int groupCount,
+        unsigned int globalCount) :
+        m_dataCount(dataCount), m_groupCount(groupCount),
+        m_globalCount(globalCount),
+        m_code(dataCount, 1, dataCount + globalCount) {
+    if (dataCount < 1 || groupCount < 1 || groupCount > dataCount
+            || dataCount + groupCount + globalCount > 256
+            || m_code.error() != RS::e_rscode_sts_ok) {
+        m_error = RS::e_rscode_sts_construct_err;
+        return;
+    }
+    m_group.resize(dataCount);
+    for (unsigned int g = 0; g < groupCount; ++g) {
+        for (unsigned int i = groupFirst(g); i < groupLast(g); ++i) {
+            m_group[i] = g;
+        }
+    }
+    m_ones.assign(dataCount, 1);
+    m_error = RS::e_rscode_sts_ok;
+}
+
+RSlrcCode::E_RSCODE_STS RSlrcCode::encode(const unsigned char * const *data,
+        unsigned char * const *parity, size_t shardSize) const {
+    if (m_error != RS::e_rscode_sts_ok) {
+        return m_error;
+    }
+    for (unsigned int g = 0; g < m_groupCount; ++g) {
+        GF28Region::dotProduct(parity[g], data + groupFirst(g), 0, &m_ones[0],
+                groupLast(g) - groupFirst(g), shardSize);
+    }
+    if (m_globalCount == 0) {
+        return RS::e_rscode_sts_ok;
+    }
+    return m_code.encodeStripe(data, parity + m_groupCount, m_globalCount,
+            shardSize);
+}
+
+void RSlrcCode::row(unsigned int r, vector<GF28Value> &coefficients) const {
+    coefficients.assign(m_dataCount, GF28Value(0));
+    if (r < m_dataCount) {
+        coefficients[r] = GF28Value(1);
+    } else if (r < m_dataCount + m_groupCount) {
+        const unsigned int g = r - m_dataCount;
+        for (unsigned int i = groupFirst(g); i < groupLast(g); ++i) {
+            coefficients[i] = GF28Value(1);
+        }
+    } else {
+        /* FEC row of m_code */
+        for (unsigned int i = 0; i < m_dataCount; ++i) {
+            coefficients[i] = m_code.coefficient(r - m_groupCount, i);
+        }
+    }
+}
+
+/* The lost data shards M are solved from |M| parities whose rows restricted
+ * to M are independent: the local parities of the damaged groups are tried
+ * first and the global ones only when those do not suffice. With P the
+ * chosen parities and A their rows, M = A[P][M]^-1 * (P - A[P][others] * others),
+ * and only the other data shards with a non-zero coefficient are read. */
+RSlrcCode::E_RSCODE_STS RSlrcCode::planRepair(const unsigned int *lost,
+        unsigned int lostCount, RepairPlan &plan) const {
+    plan.m_lost.clear();
+    plan.m_read.clear();
+    plan.m_missing.clear();
+    plan.m_matrix.clear();
+    plan.m_columns = 0;
+    plan.m_local = true;
+    if (m_error != RS::e_rscode_sts_ok) {
+        return m_error;
+    }
+    const unsigned int n = shardCount();
+    vector<bool> isLost(n, false);
+    for (unsigned int i = 0; i < lostCount; ++i) {
+        if (lost[i] >= n) {
+            return RS::e_rscode_sts_index_err;
+        }
+        isLost[lost[i]] = true;
+    }
+    vector<bool> damaged(m_groupCount, false);
+    for (unsigned int r = 0; r < n; ++r) {
+        if (!isLost[r]) {
+            continue;
+        }
+        plan.m_lost.push_back(r);
+        if (r < m_dataCount) {
+            plan.m_missing.push_back(r);
+            damaged[m_group[r]] = true;
+        } else if (r >= m_dataCount + m_groupCount) {
+            plan.m_local = false;
+        }
+    }
+    const vector<unsigned int> &missing = plan.m_missing;
+    const unsigned int count = missing.size();
+
+    /* Candidate parities, local first */
+    vector<unsigned int> candidates;
+    for (unsigned int g = 0; g < m_groupCount; ++g) {
+        if (damaged[g] && !isLost[m_dataCount + g]) {
+            candidates.push_back(m_dataCount + g);
+        }
+    }
+    for (unsigned int j = 0; j < m_globalCount; ++j) {
+        if (!isLost[m_dataCount + m_groupCount + j]) {
+            candidates.push_back(m_dataCount + m_groupCount + j);
+        }
+    }
+    /* Pick independent rows by elimination on the columns of M */
+    const GF28Value zero(0);
+    vector<GF28Value> coefficients;
+    vector<vector<GF28Value> > basis;
+    vector<unsigned int> pivots;
+    vector<unsigned int> chosen;
+    for (size_t c = 0; c < candidates.size() && chosen.size() < count; ++c) {
+        row(candidates[c], coefficients);
+        vector<GF28Value> v(count);
+        for (unsigned int a = 0; a < count; ++a) {
+            v[a] = coefficients[missing[a]];
+        }
+        for (size_t b = 0; b < basis.size(); ++b) {
+            const GF28Value f = v[pivots[b]];
+            if (f == zero) {
+                continue;
+            }
+            for (unsigned int a = 0; a < count; ++a) {
+                v[a] = v[a] - f * basis[b][a];
+            }
+        }
+        unsigned int p = 0;
+        while (p < count && v[p] == zero) {
+            ++p;
+        }
+        if (p == count) {
+            continue;
+        }
+        const GF28Value f = v[p].inverse();
+        for (unsigned int a = 0; a < count; ++a) {
+            v[a] = v[a] * f;
+        }
+        basis.push_back(v);
+        pivots.push_back(p);
+        chosen.push_back(candidates[c]);
+    }
+    if (chosen.size() < count) {
+        return RS::e_rscode_sts_shards_err;
+    }
+
+    /* rows[c] = coefficients of chosen[c] over all data */
+    vector<vector<GF28Value> > rows(count);
+    vector<GF28Value> a(count * count);
+    for (unsigned int c = 0; c < count; ++c) {
+        row(chosen[c], rows[c]);
+        for (unsigned int m = 0; m < count; ++m) {
+            a[c * count + m] = rows[c][missing[m]];
+        }
+        if (chosen[c] >= m_dataCount + m_groupCount) {
+            plan.m_local = false;
+        }
+    }
+    vector<GF28Value> inverse(count * count);
+    if (count > 0 && !RS::inverseMatrix(a.data(), inverse.data(), count)) {
+        return RS::e_rscode_sts_singular_err;
+    }
+    /* Sources: the chosen parities, then the data they depend on */
+    vector<vector<GF28Value> > columns;
+    for (unsigned int c = 0; c < count; ++c) {
+        vector<GF28Value> column(count);
+        for (unsigned int m = 0; m < count; ++m) {
+            column[m] = inverse[m * count + c];
+        }
+        plan.m_read.push_back(chosen[c]);
+        columns.push_back(column);
+    }
+    for (unsigned int i = 0; i < m_dataCount && count > 0; ++i) {
+        if (isLost[i]) {
+            continue;
+        }
+        /* Moving data i to the right hand side: M -= inverse * A[P][i] * i */
+        vector<GF28Value> column(count, zero);
+        bool used = false;
+        for (unsigned int m = 0; m < count; ++m) {
+            GF28Value t(0);
+            for (unsigned int c = 0; c < count; ++c) {
+                t = t + inverse[m * count + c] * rows[c][i];
+            }
+            column[m] = t;
+            used = used || t != zero;
+        }
+        if (used) {
+            plan.m_read.push_back(i);
+            columns.push_back(column);
+        }
+    }
+    plan.m_columns = plan.m_read.size();
+    plan.m_matrix.resize(count * plan.m_columns);
+    for (unsigned int m = 0; m < count; ++m) {
+        for (unsigned int s = 0; s < plan.m_columns; ++s) {
+            plan.m_matrix[m * plan.m_columns + s] = columns[s][m].value();
+        }
+    }
+
+    /* Lost parities are encoded again from their data */
+    vector<bool> read(n, false);
+    for (size_t s = 0; s < plan.m_read.size(); ++s) {
+        read[plan.m_read[s]] = true;
+    }
+    for (size_t l = 0; l < plan.m_lost.size(); ++l) {
+        const unsigned int r = plan.m_lost[l];
+        if (r < m_dataCount) {
+            continue;
+        }
+        unsigned int first = 0;
+        unsigned int last = m_dataCount;
+        if (r < m_dataCount + m_groupCount) {
+            first = groupFirst(r - m_dataCount);
+            last = groupLast(r - m_dataCount);
+        }
+        for (unsigned int i = first; i < last; ++i) {
+            if (!isLost[i] && !read[i]) {
+                plan.m_read.push_back(i);
+                read[i] = true;
+            }
+        }
+    }
+    return RS::e_rscode_sts_ok;
+}
+
+RSlrcCode::E_RSCODE_STS RSlrcCode::repair(const RepairPlan &plan,
+        unsigned char * const *shards, size_t shardSize) const {
+    if (m_error != RS::e_rscode_sts_ok) {
+        return m_error;
+    }
+    const unsigned int count = plan.m_missing.size();
+    if (count > 0) {
+        vector<const unsigned char*> src(plan.m_columns);
+        for (unsigned int s = 0; s < plan.m_columns; ++s) {
+            src[s] = shards[plan.m_read[s]];
+        }
+        for (unsigned int m = 0; m < count; ++m) {
+            GF28Region::dotProduct(shards[plan.m_missing[m]], &src[0], 0,
+                    &plan.m_matrix[m * plan.m_columns], plan.m_columns, shardSize);
+        }
+    }
+    /* The data is complete now */
+    for (size_t l = 0; l < plan.m_lost.size(); ++l) {
+        const unsigned int r = plan.m_lost[l];
+        if (r < m_dataCount) {
+            continue;
+        }
+        if (r < m_dataCount + m_groupCount) {
+            const unsigned int g = r - m_dataCount;
+            GF28Region::dotProduct(shards[r], shards + groupFirst(g), 0,
+                    &m_ones[0], groupLast(g) - groupFirst(g), shardSize);
+        } else {
+            GF28Region::dotProduct(shards[r], shards, 0,
+                    m_code.parityRow(r - m_dataCount - m_groupCount),
+                    m_dataCount, shardSize);
+        }
+    }
+    return RS::e_rscode_sts_ok;
+}
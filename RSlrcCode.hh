@@ -0,0 +1,92 @@
+/*
+ * RSlrcCode.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSLRCCODE_HH_
+#define RSLRCCODE_HH_
+
+#include <vector>
+
+#include "GF28Value.hh"
+#include "RScode.hh"
+
+/* Locally repairable code over GF(2^8).
+ * The dataCount data shards are split into groupCount local groups of
+ * consecutive shards, each with a local parity (the xor of its data), and
+ * globalCount global parities are the FEC lines of RScode over all data.
+ * Shards are numbered data 0..dataCount-1, then the local parities
+ * 0..groupCount-1 and the global parities 0..globalCount-1.
+ * One lost shard of a group is repaired from the rest of its group, so
+ * repair reads about dataCount / groupCount shards instead of dataCount.
+ * Other failures are solved with the local and global parities together.
+ *  */
+class RSlrcCode {
+public:
+    typedef RScode<GF28Value>::E_RSCODE_STS E_RSCODE_STS;
+    /* Shards to read and how to rebuild the lost ones (immutable once planned) */
+    struct RepairPlan {
+        std::vector<unsigned int> m_lost;       /* Shards to repair */
+        std::vector<unsigned int> m_read;       /* Shards to read */
+        bool m_local;                           /* Only local groups are read */
+        std::vector<unsigned int> m_missing;    /* Lost data shards */
+        unsigned int m_columns;                 /* Leading shards of m_read they are solved from */
+        std::vector<unsigned char> m_matrix;    /* Their rows over those shards */
+    };
+
+public:
+    RSlrcCode(unsigned int dataCount, unsigned int groupCount,
+            unsigned int globalCount);
+    ~RSlrcCode() {
+    }
+    RSlrcCode(const RSlrcCode &) = delete;
+    RSlrcCode& operator=(const RSlrcCode &) = delete;
+
+    /* data[0..dataCount-1] are the data shards, parity[0..groupCount-1]
+     * receive the local and parity[groupCount..] the global parities */
+    E_RSCODE_STS encode(const unsigned char * const *data,
+            unsigned char * const *parity, size_t shardSize) const;
+    /* Plan the repair of lost[0..lostCount-1]: a lone loss in a group is
+     * repaired from its group, the rest are solved with the fewest global
+     * parities. Returns shards_err if the shards can not be rebuilt. */
+    E_RSCODE_STS planRepair(const unsigned int *lost, unsigned int lostCount,
+            RepairPlan &plan) const;
+    /* shards[r] is shard r: the shards of plan.m_read are read and those of
+     * plan.m_lost are rebuilt, other entries are not used */
+    E_RSCODE_STS repair(const RepairPlan &plan, unsigned char * const *shards,
+            size_t shardSize) const;
+
+    /* Group of data shard i, and its data shards [first, last) */
+    inline unsigned int group(unsigned int i) const {
+        return m_group[i];
+    }
+    inline unsigned int groupFirst(unsigned int g) const {
+        return g * m_dataCount / m_groupCount;
+    }
+    inline unsigned int groupLast(unsigned int g) const {
+        return (g + 1) * m_dataCount / m_groupCount;
+    }
+    inline E_RSCODE_STS error(void) const {return m_error;};
+    inline unsigned int dataCount(void) const {return m_dataCount;};
+    inline unsigned int groupCount(void) const {return m_groupCount;};
+    inline unsigned int globalCount(void) const {return m_globalCount;};
+    inline unsigned int shardCount(void) const {
+        return m_dataCount + m_groupCount + m_globalCount;
+    }
+
+private:
+    /* Coefficients of shard r over the data shards */
+    void row(unsigned int r, std::vector<GF28Value> &coefficients) const;
+
+private:
+    unsigned int m_dataCount;
+    unsigned int m_groupCount;
+    unsigned int m_globalCount;
+    std::vector<unsigned int> m_group;          /* Group of every data shard */
+    std::vector<unsigned char> m_ones;          /* Coefficients of a local parity */
+    RScode<GF28Value> m_code;                   /* Global parities */
+    E_RSCODE_STS m_error = RScode<GF28Value>::e_rscode_sts_init;
+};
+
+#endif /* RSLRCCODE_HH_ */
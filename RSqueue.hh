@@ -0,0 +1,240 @@
+/*
+ * RSqueue.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSQUEUE_HH_
+#define RSQUEUE_HH_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <chrono>
+
+#include "RScode.hh"
+#include "ThreadPool.hh"
+
+/* Asynchronous encoding of small stripes.
+ * Any thread submits encodeStripe requests with a completion callback or
+ * gets a future. A dispatcher thread coalesces the queued requests into
+ * batches of up to batchSize, waiting at most maxDelay microseconds after
+ * the oldest one was queued, and encodes a batch on the pool in as many
+ * contiguous runs of requests as there are workers, so small stripes do
+ * not pay a task each. Within a run, consecutive requests of the same
+ * parityCount and shardSize are encoded by one RScode::encodeStripes.
+ * Requests complete in submission order: the callbacks of a batch are
+ * called by the dispatcher one after another.
+ * All requests share the codec, so they have its encodeLineSize, the
+ * parityCount and shardSize of each request are free.
+ * Callbacks run on the dispatcher thread: they may submit, but flush
+ * called from a callback returns without waiting (the batch of the
+ * callback cannot complete before it returns), and the queue must not be
+ * destroyed from a callback.
+ *  */
+template<typename T>
+class RSqueue {
+public:
+    typedef typename RScode<T>::E_RSCODE_STS E_RSCODE_STS;
+    typedef std::function<void(E_RSCODE_STS)> CALLBACK;
+    static const unsigned int BATCH_SIZE = 32;      /* Default requests per batch */
+    static const unsigned int MAX_DELAY = 50;       /* Default queueing delay (us) */
+
+public:
+    /* threadCount 0 means one thread per hardware thread */
+    RSqueue(const RScode<T> &code, unsigned int threadCount = 0,
+            unsigned int batchSize = BATCH_SIZE, unsigned int maxDelay = MAX_DELAY) :
+            m_code(code), m_pool(threadCount),
+            m_batchSize(batchSize ? batchSize : 1), m_maxDelay(maxDelay),
+            m_submitted(0), m_completed(0), m_batches(0), m_flushing(0),
+            m_flush(false), m_stop(false) {
+        m_dispatcher = std::thread(&RSqueue::dispatch, this);
+    }
+    /* Pending requests are completed first */
+    ~RSqueue() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        m_dispatcher.join();
+    }
+    RSqueue(const RSqueue &) = delete;
+    RSqueue& operator=(const RSqueue &) = delete;
+
+    /* Queue RScode::encodeStripe(data, parity, parityCount, shardSize),
+     * callback receives its status. The pointer arrays and the shards must
+     * stay valid until the request completes.
+     *  */
+    void submit(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize, const CALLBACK &callback) {
+        Request r;
+        r.m_data = data;
+        r.m_parity = parity;
+        r.m_parityCount = parityCount;
+        r.m_shardSize = shardSize;
+        r.m_callback = callback;
+        r.m_time = CLOCK::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(r);
+            ++m_submitted;
+        }
+        m_cond.notify_all();
+    }
+    std::future<E_RSCODE_STS> submit(const unsigned char * const *data,
+            unsigned char * const *parity, unsigned int parityCount,
+            size_t shardSize) {
+        std::shared_ptr<std::promise<E_RSCODE_STS> > promise(
+                new std::promise<E_RSCODE_STS>());
+        submit(data, parity, parityCount, shardSize, [promise](E_RSCODE_STS sts) {
+            promise->set_value(sts);
+        });
+        return promise->get_future();
+    }
+    /* Wait until every request submitted so far has completed, the queued
+     * ones are dispatched without waiting for maxDelay.
+     * From a callback it only dispatches, it would otherwise deadlock. */
+    void flush(void) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (std::this_thread::get_id() == m_dispatcher.get_id()) {
+            m_flush = true;
+            return;
+        }
+        const unsigned long long submitted = m_submitted;
+        ++m_flushing;
+        m_cond.notify_all();
+        m_doneCond.wait(lock, [this, submitted] {
+            return m_completed >= submitted;
+        });
+        --m_flushing;
+    }
+
+    inline unsigned int batchSize(void) const {
+        return m_batchSize;
+    }
+    inline unsigned int maxDelay(void) const {
+        return m_maxDelay;
+    }
+    /* Completed requests and the batches they ran in */
+    unsigned long long completed(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_completed;
+    }
+    unsigned long long batches(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batches;
+    }
+
+private:
+    typedef std::chrono::steady_clock CLOCK;
+    struct Request {
+        const unsigned char * const *m_data;
+        unsigned char * const *m_parity;
+        unsigned int m_parityCount;
+        size_t m_shardSize;
+        CALLBACK m_callback;
+        CLOCK::time_point m_time;               /* Submission */
+        E_RSCODE_STS m_status;
+    };
+
+    void dispatch(void) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_cond.wait(lock, [this] {
+                return m_stop || !m_queue.empty();
+            });
+            if (m_queue.empty()) {
+                break;
+            }
+            /* Coalesce until the batch is full, the oldest request is due
+             * or a flush waits */
+            const CLOCK::time_point due = m_queue.front().m_time
+                    + std::chrono::microseconds(m_maxDelay);
+            m_cond.wait_until(lock, due, [this] {
+                return m_stop || m_flushing > 0 || m_flush
+                        || m_queue.size() >= m_batchSize;
+            });
+            m_flush = false;
+            size_t n = m_queue.size();
+            if (n > m_batchSize) {
+                n = m_batchSize;
+            }
+            m_batch.assign(m_queue.begin(), m_queue.begin() + n);
+            m_queue.erase(m_queue.begin(), m_queue.begin() + n);
+            lock.unlock();
+            m_data.resize(n);
+            m_parity.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                m_data[i] = m_batch[i].m_data;
+                m_parity[i] = m_batch[i].m_parity;
+            }
+            run();
+            for (size_t i = 0; i < m_batch.size(); ++i) {
+                if (m_batch[i].m_callback) {
+                    m_batch[i].m_callback(m_batch[i].m_status);
+                }
+            }
+            m_batch.clear();
+            lock.lock();
+            m_completed += n;
+            ++m_batches;
+            m_doneCond.notify_all();
+        }
+    }
+    /* Encode the batch in one contiguous run of requests per worker, a
+     * run in one encodeStripes per group of requests of the same shape */
+    void run(void) {
+        const size_t n = m_batch.size();
+        size_t runs = m_pool.size();
+        if (runs > n) {
+            runs = n;
+        }
+        m_pool.parallelFor(runs, [this, n, runs](size_t t) {
+            const size_t end = (t + 1) * n / runs;
+            size_t i = t * n / runs;
+            while (i < end) {
+                const Request &first = m_batch[i];
+                size_t j = i + 1;
+                while (j < end && m_batch[j].m_parityCount == first.m_parityCount
+                        && m_batch[j].m_shardSize == first.m_shardSize) {
+                    ++j;
+                }
+                const E_RSCODE_STS sts = m_code.encodeStripes(&m_data[i],
+                        &m_parity[i], j - i, first.m_parityCount,
+                        first.m_shardSize);
+                for (; i < j; ++i) {
+                    m_batch[i].m_status = sts;
+                }
+            }
+        });
+    }
+
+private:
+    const RScode<T> &m_code;
+    ThreadPool m_pool;
+    unsigned int m_batchSize;
+    unsigned int m_maxDelay;
+    std::mutex m_mutex;                     /* Guards the queue and the counters */
+    std::condition_variable m_cond;         /* Queue changed or stop */
+    std::condition_variable m_doneCond;     /* Batch completed */
+    std::deque<Request> m_queue;
+    std::vector<Request> m_batch;           /* Batch of the dispatcher */
+    std::vector<const unsigned char * const *> m_data;  /* Shards of m_batch */
+    std::vector<unsigned char * const *> m_parity;
+    unsigned long long m_submitted;
+    unsigned long long m_completed;
+    unsigned long long m_batches;
+    unsigned int m_flushing;                /* Threads waiting in flush */
+    bool m_flush;                           /* Flush from a callback */
+    bool m_stop;
+    std::thread m_dispatcher;
+};
+
+#endif /* RSQUEUE_HH_ */
@@ -0,0 +1,175 @@
+/*
+ * RSstats.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+
+#include "RSstats.hh"
+
+using namespace std;
+
+/* Blocks of the live threads, the totals of the exited ones and the
+ * snapshot of the last reset */
+struct _REGISTRY {
+    mutex m_mutex;
+    vector<RSstats::Block*> m_blocks;
+    RSstats::Snapshot m_retired;
+    RSstats::Snapshot m_base;
+    _REGISTRY() {
+        memset(&m_retired, 0, sizeof(m_retired));
+        memset(&m_base, 0, sizeof(m_base));
+    }
+};
+
+/* Never destroyed, threads may exit after the static destructors ran */
+static _REGISTRY& registry(void) {
+    static _REGISTRY *s_registry = new _REGISTRY;
+    return *s_registry;
+}
+
+static atomic<RSstats::TRACE_HOOK> s_hook(NULL);
+
+/* to += from */
+static void accumulate(RSstats::Snapshot &to, const RSstats::Block &from) {
+    for (unsigned int i = 0; i < RSstats::e_rs_stat_max; ++i) {
+        to.m_counter[i] += from.m_counter[i].load(memory_order_relaxed);
+    }
+    for (unsigned int i = 0; i < RSstats::KERNEL_SLOTS; ++i) {
+        to.m_kernelCalls[i] += from.m_kernelCalls[i].load(memory_order_relaxed);
+    }
+    for (unsigned int h = 0; h < RSstats::e_rs_hist_max; ++h) {
+        for (unsigned int i = 0; i < RSstats::HIST_BUCKETS; ++i) {
+            to.m_hist[h][i] += from.m_hist[h][i].load(memory_order_relaxed);
+        }
+    }
+}
+
+/* new does not align beyond the fundamental alignment before C++17 */
+RSstats::Holder::Holder() {
+    void *p = NULL;
+    if (posix_memalign(&p, alignof(Block), sizeof(Block)) != 0) {
+        throw bad_alloc();
+    }
+    m_block = new (p) Block;
+    for (unsigned int i = 0; i < e_rs_stat_max; ++i) {
+        m_block->m_counter[i] = 0;
+    }
+    for (unsigned int i = 0; i < KERNEL_SLOTS; ++i) {
+        m_block->m_kernelCalls[i] = 0;
+    }
+    for (unsigned int h = 0; h < e_rs_hist_max; ++h) {
+        for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+            m_block->m_hist[h][i] = 0;
+        }
+    }
+    _REGISTRY &r = registry();
+    lock_guard<mutex> lock(r.m_mutex);
+    r.m_blocks.push_back(m_block);
+}
+
+RSstats::Holder::~Holder() {
+    _REGISTRY &r = registry();
+    {
+        lock_guard<mutex> lock(r.m_mutex);
+        accumulate(r.m_retired, *m_block);
+        r.m_blocks.erase(find(r.m_blocks.begin(), r.m_blocks.end(), m_block));
+    }
+    m_block->~Block();
+    free(m_block);
+}
+
+RSstats::Snapshot RSstats::snapshot(void) {
+    _REGISTRY &r = registry();
+    lock_guard<mutex> lock(r.m_mutex);
+    Snapshot s = r.m_retired;
+    for (size_t b = 0; b < r.m_blocks.size(); ++b) {
+        accumulate(s, *r.m_blocks[b]);
+    }
+    for (unsigned int i = 0; i < e_rs_stat_max; ++i) {
+        s.m_counter[i] -= r.m_base.m_counter[i];
+    }
+    for (unsigned int i = 0; i < KERNEL_SLOTS; ++i) {
+        s.m_kernelCalls[i] -= r.m_base.m_kernelCalls[i];
+    }
+    for (unsigned int h = 0; h < e_rs_hist_max; ++h) {
+        for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+            s.m_hist[h][i] -= r.m_base.m_hist[h][i];
+        }
+    }
+    return s;
+}
+
+/* The blocks are only written by their threads, so a reset moves the base
+ * instead of clearing them */
+void RSstats::reset(void) {
+    Snapshot s = snapshot();
+    _REGISTRY &r = registry();
+    lock_guard<mutex> lock(r.m_mutex);
+    for (unsigned int i = 0; i < e_rs_stat_max; ++i) {
+        r.m_base.m_counter[i] += s.m_counter[i];
+    }
+    for (unsigned int i = 0; i < KERNEL_SLOTS; ++i) {
+        r.m_base.m_kernelCalls[i] += s.m_kernelCalls[i];
+    }
+    for (unsigned int h = 0; h < e_rs_hist_max; ++h) {
+        for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+            r.m_base.m_hist[h][i] += s.m_hist[h][i];
+        }
+    }
+}
+
+void RSstats::setTraceHook(TRACE_HOOK hook) {
+    s_hook.store(hook);
+}
+
+void RSstats::record(E_RS_TRACE type, size_t bytes, unsigned long long start,
+        unsigned long long duration) {
+    Block *b = local();
+    if (type == e_rs_trace_invert) {
+        bump(b->m_counter[e_rs_stat_invert_ns], duration);
+    } else {
+        const bool encode = type == e_rs_trace_encode;
+        bump(b->m_counter[encode ? e_rs_stat_encode_calls : e_rs_stat_decode_calls], 1);
+        bump(b->m_counter[encode ? e_rs_stat_encode_bytes : e_rs_stat_decode_bytes], bytes);
+        bump(b->m_counter[e_rs_stat_data_ns], duration);
+        unsigned int bucket = 0;
+        while (bucket + 1 < HIST_BUCKETS && (duration >> (bucket + 1)) != 0) {
+            ++bucket;
+        }
+        bump(b->m_hist[encode ? e_rs_hist_encode : e_rs_hist_decode][bucket], 1);
+    }
+    TRACE_HOOK hook = s_hook.load(memory_order_relaxed);
+    if (hook != NULL) {
+        TraceEvent e;
+        e.m_type = type;
+        e.m_start = start;
+        e.m_duration = duration;
+        e.m_bytes = bytes;
+        hook(e);
+    }
+}
+
+unsigned long long RSstats::Snapshot::percentile(E_RS_HIST hist, double p) const {
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        total += m_hist[hist][i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    unsigned long long seen = 0;
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += m_hist[hist][i];
+        if (seen >= p * total) {
+            return 2ull << i;
+        }
+    }
+    return 2ull << (HIST_BUCKETS - 1);
+}
@@ -0,0 +1,142 @@
+/*
+ * RSstats.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSSTATS_HH_
+#define RSSTATS_HH_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/* Counters and latency histograms of the hot paths.
+ * Every thread counts into its own block, so counting is a relaxed load
+ * and store on a cache line no other thread writes. snapshot() sums the
+ * blocks of the live threads and of the threads which exited.
+ * An optional trace hook receives an event at the end of every encoding
+ * or decoding pass and matrix inversion.
+ * With -DRSCODE_NO_STATS everything compiles to nothing (snapshot() is
+ * all zeros and the hook is never called).
+ *  */
+class RSstats {
+public:
+    typedef enum {
+        e_rs_stat_encode_calls = 0,     /* Encoding passes */
+        e_rs_stat_encode_bytes,         /* Data bytes encoded */
+        e_rs_stat_decode_calls,         /* Decoding passes */
+        e_rs_stat_decode_bytes,         /* Bytes decoded (missing lines) */
+        e_rs_stat_plan_hits,            /* Decode cache hits */
+        e_rs_stat_plan_misses,          /* Decode cache misses */
+        e_rs_stat_invert_ns,            /* Time in matrix inversion */
+        e_rs_stat_data_ns,              /* Time in encoding and decoding passes */
+        e_rs_stat_allocations,          /* Matrix arenas and decoding rows */
+        e_rs_stat_allocated_bytes,
+        e_rs_stat_max,
+    } E_RS_STAT;
+    typedef enum {
+        e_rs_hist_encode = 0,           /* Latency of encoding passes */
+        e_rs_hist_decode,               /* Latency of decoding passes */
+        e_rs_hist_max,
+    } E_RS_HIST;
+    typedef enum {
+        e_rs_trace_encode = 0,
+        e_rs_trace_decode,
+        e_rs_trace_invert,
+    } E_RS_TRACE;
+    static const unsigned int KERNEL_SLOTS = 8;     /* GF(2^8) kernel variants */
+    static const unsigned int HIST_BUCKETS = 40;    /* Bucket b counts [2^b, 2^(b+1)) ns */
+#ifdef RSCODE_NO_STATS
+    static const bool ENABLED = false;
+#else
+    static const bool ENABLED = true;
+#endif
+
+    struct Snapshot {
+        unsigned long long m_counter[e_rs_stat_max];
+        unsigned long long m_kernelCalls[KERNEL_SLOTS];     /* By GF28Region::E_GF28_KERNEL */
+        unsigned long long m_hist[e_rs_hist_max][HIST_BUCKETS];
+        /* Latency below which a fraction p of the passes completed (ns,
+         * upper bound of the bucket) */
+        unsigned long long percentile(E_RS_HIST hist, double p) const;
+    };
+    struct TraceEvent {
+        E_RS_TRACE m_type;
+        unsigned long long m_start;     /* steady_clock, ns */
+        unsigned long long m_duration;  /* ns */
+        size_t m_bytes;
+    };
+    typedef void (*TRACE_HOOK)(const TraceEvent &event);
+
+    /* Per-thread counters, on cache lines of their own */
+    struct alignas(64) Block {
+        std::atomic<unsigned long long> m_counter[e_rs_stat_max];
+        std::atomic<unsigned long long> m_kernelCalls[KERNEL_SLOTS];
+        std::atomic<unsigned long long> m_hist[e_rs_hist_max][HIST_BUCKETS];
+    };
+
+    /* Times a pass from construction to destruction: counts calls, bytes,
+     * time and latency and calls the trace hook */
+    class Scope {
+    public:
+#ifdef RSCODE_NO_STATS
+        Scope(E_RS_TRACE, size_t) {
+        }
+#else
+        Scope(E_RS_TRACE type, size_t bytes) :
+                m_type(type), m_bytes(bytes), m_start(now()) {
+        }
+        ~Scope() {
+            RSstats::record(m_type, m_bytes, m_start, now() - m_start);
+        }
+    private:
+        E_RS_TRACE m_type;
+        size_t m_bytes;
+        unsigned long long m_start;
+#endif
+    };
+
+public:
+    static inline void add(E_RS_STAT stat, unsigned long long n = 1) {
+#ifndef RSCODE_NO_STATS
+        bump(local()->m_counter[stat], n);
+#endif
+    }
+    static inline void kernelCall(unsigned int kernel) {
+#ifndef RSCODE_NO_STATS
+        bump(local()->m_kernelCalls[kernel % KERNEL_SLOTS], 1);
+#endif
+    }
+    /* Totals since the start or the last reset() */
+    static Snapshot snapshot(void);
+    static void reset(void);
+    /* NULL removes the hook */
+    static void setTraceHook(TRACE_HOOK hook);
+
+    static inline unsigned long long now(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    static inline void bump(std::atomic<unsigned long long> &c,
+            unsigned long long n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    /* Block of the calling thread, registered at its first use */
+    static inline Block* local(void) {
+        static thread_local Holder s_holder;
+        return s_holder.m_block;
+    }
+    static void record(E_RS_TRACE type, size_t bytes, unsigned long long start,
+            unsigned long long duration);
+
+    struct Holder {
+        Holder();
+        ~Holder();
+        Block *m_block;
+    };
+};
+
+#endif /* RSSTATS_HH_ */
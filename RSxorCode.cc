@@ -0,0 +1,378 @@
+/*
+ * RSxorCode.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include <iostream>
+#include <cstring>
+#include <atomic>
+
+#include "GF28Region.hh"
+#include "RSxorCode.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RSXOR_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+typedef RScode<GF28Value> RS;
+
+/* Unique code identity, 0 is none */
+static unsigned long long newId(void) {
+    static atomic<unsigned long long> s_lastId(0);
+    return s_lastId.fetch_add(1, memory_order_relaxed) + 1;
+}
+
+/* dst ^= src */
+static void xorScalar(unsigned char *dst, const unsigned char *src, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        unsigned long long a, b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < len; ++i) {
+        dst[i] ^= src[i];
+    }
+}
+
+#ifdef RSXOR_X86
+__attribute__((target("avx2")))
+static void xorAvx2(unsigned char *dst, const unsigned char *src, size_t len) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (dst + i)),
+                _mm256_loadu_si256((const __m256i *) (src + i)));
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (dst + i + 32)),
+                _mm256_loadu_si256((const __m256i *) (src + i + 32)));
+        _mm256_storeu_si256((__m256i *) (dst + i), a);
+        _mm256_storeu_si256((__m256i *) (dst + i + 32), b);
+    }
+    xorScalar(dst + i, src + i, len - i);
+}
+#endif
+
+typedef void (*XOR_FUNC)(unsigned char *dst, const unsigned char *src, size_t len);
+
+/* xor kernel singleton */
+static XOR_FUNC getXorFunc(void) {
+    static const XOR_FUNC s_xor =
+#ifdef RSXOR_X86
+            GF28Region::isSupported(GF28Region::e_gf28_kernel_avx2) ? xorAvx2 :
+#endif
+            xorScalar;
+    return s_xor;
+}
+
+/* Bit j of x's row i: bit i of c*2^j */
+static inline bool bit(unsigned char c, unsigned int i, unsigned int j) {
+    return ((GF28Value(c) * GF28Value(1u << j)).value() >> i) & 1;
+}
+
+/* Ones of the bit matrices of a row */
+static unsigned int ones(const unsigned char *row, unsigned int n) {
+    unsigned int count = 0;
+    for (unsigned int c = 0; c < n; ++c) {
+        for (unsigned int i = 0; i < RSxorCode::W; ++i) {
+            for (unsigned int j = 0; j < RSxorCode::W; ++j) {
+                count += bit(row[c], i, j);
+            }
+        }
+    }
+    return count;
+}
+
+RSxorCode::RSxorCode(unsigned int dataCount, unsigned int parityCount,
+        size_t packetSize) :
+        m_dataCount(dataCount), m_parityCount(parityCount),
+        m_packetSize((packetSize + 63) / 64 * 64) {
+    if (dataCount < 1 || parityCount < 1 || m_packetSize == 0
+            || dataCount + parityCount > GF28Value::limit()) {
+        m_state = m_error = RS::e_rscode_sts_construct_err;
+        return;
+    }
+    /* Cauchy matrix 1/(x+y), x = {dataCount,...}, y = {0,...,dataCount-1} */
+    m_matrix.resize(parityCount * dataCount);
+    for (unsigned int i = 0; i < parityCount; ++i) {
+        for (unsigned int j = 0; j < dataCount; ++j) {
+            m_matrix[i * dataCount + j] = (GF28Value(1)
+                    / (GF28Value(dataCount + i) + GF28Value(j))).value();
+        }
+    }
+    /* Divide every column by its first element, so the first FEC row is all
+     * identity matrices, then divide every other row by the element giving
+     * the fewest ones */
+    for (unsigned int j = 0; j < dataCount; ++j) {
+        GF28Value d(m_matrix[j]);
+        for (unsigned int i = 0; i < parityCount; ++i) {
+            m_matrix[i * dataCount + j] = (GF28Value(m_matrix[i * dataCount + j]) / d).value();
+        }
+    }
+    vector<unsigned char> row(dataCount);
+    for (unsigned int i = 1; i < parityCount; ++i) {
+        unsigned char *p = &m_matrix[i * dataCount];
+        unsigned int best = ones(p, dataCount);
+        GF28Value divisor(1);
+        for (unsigned int c = 0; c < dataCount; ++c) {
+            for (unsigned int j = 0; j < dataCount; ++j) {
+                row[j] = (GF28Value(p[j]) / GF28Value(p[c])).value();
+            }
+            unsigned int n = ones(row.data(), dataCount);
+            if (n < best) {
+                best = n;
+                divisor = GF28Value(p[c]);
+            }
+        }
+        for (unsigned int j = 0; j < dataCount; ++j) {
+            p[j] = (GF28Value(p[j]) / divisor).value();
+        }
+    }
+    buildSchedule(m_matrix.data(), parityCount, dataCount, m_encode);
+    m_pDecodeCache = new SCHEDULE_CACHE(DECODE_CACHE_SIZE);
+    m_id = newId();
+    m_state = m_error = RS::e_rscode_sts_ok;
+}
+
+RSxorCode::~RSxorCode() {
+    if (m_pDecodeCache)
+        delete m_pDecodeCache;
+}
+
+unsigned char RSxorCode::coefficient(unsigned int r, unsigned int j) const {
+    return m_matrix[r * m_dataCount + j];
+}
+
+RSxorCode::E_RSCODE_STS RSxorCode::encode(const unsigned char * const *data,
+        unsigned char * const *parity, size_t shardSize) const {
+    if (m_state != RS::e_rscode_sts_ok) {
+        return m_state;
+    }
+    if (shardSize == 0 || shardSize % W != 0) {
+        return RS::e_rscode_sts_size_err;
+    }
+    run(m_encode, data, parity, shardSize);
+    return RS::e_rscode_sts_ok;
+}
+
+int RSxorCode::decode(const Shard *shards, unsigned int shardCount,
+        unsigned char * const *data, size_t shardSize) {
+    return report(decode(shards, shardCount, data, shardSize, m_context));
+}
+
+RSxorCode::E_RSCODE_STS RSxorCode::decode(const Shard *shards,
+        unsigned int shardCount, unsigned char * const *data, size_t shardSize,
+        Context &ctx) const {
+    if (m_state != RS::e_rscode_sts_ok) {
+        return status(ctx, m_state);
+    }
+    if (shardSize == 0 || shardSize % W != 0) {
+        return status(ctx, RS::e_rscode_sts_size_err);
+    }
+    /* Select data shards in their own places, then FEC shards in ascending
+     * index order (the same selection as RScode) */
+    const unsigned int limit = m_dataCount + m_parityCount;
+    vector<unsigned int> &index = ctx.m_index;
+    index.assign(m_dataCount, limit);
+    ctx.m_src.resize(m_dataCount);
+    ctx.m_dst.resize(m_dataCount);
+    for (unsigned int s = 0; s < shardCount; ++s) {
+        if (shards[s].index >= limit) {
+            return status(ctx, RS::e_rscode_sts_index_err);
+        }
+        if (shards[s].index < m_dataCount) {
+            index[shards[s].index] = shards[s].index;
+            ctx.m_src[shards[s].index] = shards[s].data;
+        }
+    }
+    unsigned int last = m_dataCount - 1;
+    for (unsigned int i = 0; i < m_dataCount; ++i) {
+        if (index[i] != limit) {
+            continue;
+        }
+        for (unsigned int s = 0; s < shardCount; ++s) {
+            if (shards[s].index > last && shards[s].index < index[i]) {
+                index[i] = shards[s].index;
+                ctx.m_src[i] = shards[s].data;
+            }
+        }
+        if (index[i] == limit) {
+            return status(ctx, RS::e_rscode_sts_shards_err);
+        }
+        last = index[i];
+    }
+    const Schedule *schedule = decodeSchedule(index, ctx);
+    if (schedule == NULL) {
+        return status(ctx, RS::e_rscode_sts_singular_err);
+    }
+    for (unsigned int i = 0; i < schedule->m_missing.size(); ++i) {
+        ctx.m_dst[i] = data[schedule->m_missing[i]];
+        if (ctx.m_dst[i] == NULL) {
+            return status(ctx, RS::e_rscode_sts_output_err);
+        }
+    }
+    run(*schedule, ctx.m_src.data(), ctx.m_dst.data(), shardSize);
+    return status(ctx, RS::e_rscode_sts_ok);
+}
+
+/* Status of a call without Context as 0 or -1, printing the error */
+int RSxorCode::report(E_RSCODE_STS sts) {
+    if (sts == RS::e_rscode_sts_ok) {
+        return 0;
+    }
+    m_error = sts;
+    cout << RS::errorString(sts) << endl;
+    return -1;
+}
+
+/* Rows of the missing lines of the inverse of the selected generator rows,
+ * from ctx, from the shared cache or calculated, and kept in ctx until its
+ * next decoding */
+const RSxorCode::Schedule* RSxorCode::decodeSchedule(const vector<unsigned int> &index,
+        Context &ctx) const {
+    if (ctx.m_schedule && ctx.m_scheduleCode == m_id && ctx.m_scheduleIndex == index) {
+        return ctx.m_schedule.get();
+    }
+    SCHEDULE schedule = m_pDecodeCache->get(index);
+    if (!schedule) {
+        schedule = buildDecodeSchedule(index);
+        if (!schedule) {
+            return NULL;
+        }
+        m_pDecodeCache->put(index, schedule);
+    }
+    ctx.m_scheduleIndex.assign(index.begin(), index.end());
+    ctx.m_schedule = std::move(schedule);
+    ctx.m_scheduleCode = m_id;
+    return ctx.m_schedule.get();
+}
+
+RSxorCode::SCHEDULE RSxorCode::buildDecodeSchedule(const vector<unsigned int> &index) const {
+    SCHEDULE schedule;
+    const unsigned int k = m_dataCount;
+    vector<GF28Value> sub(k * k);
+    vector<GF28Value> inv(k * k);
+    for (unsigned int i = 0; i < k; ++i) {
+        for (unsigned int j = 0; j < k; ++j) {
+            if (index[i] < k) {
+                sub[i * k + j] = GF28Value(index[i] == j ? 1 : 0);
+            } else {
+                sub[i * k + j] = GF28Value(coefficient(index[i] - k, j));
+            }
+        }
+    }
+    if (!RS::inverseMatrix(sub.data(), inv.data(), k)) {
+        return schedule;
+    }
+    Schedule *s = new Schedule;
+    vector<unsigned char> rows;
+    for (unsigned int i = 0; i < k; ++i) {
+        if (index[i] != i) {
+            s->m_missing.push_back(i);
+            for (unsigned int j = 0; j < k; ++j) {
+                rows.push_back(inv[i * k + j].value());
+            }
+        }
+    }
+    buildSchedule(rows.data(), s->m_missing.size(), k, *s);
+    schedule.reset(s);
+    return schedule;
+}
+
+/* Output row o is the xor of the input rows set in bits[o]. The row with the
+ * lowest cost is emitted next, its cost is the number of its ones, or one
+ * (copy of an emitted row) plus the ones of the difference to that row. */
+void RSxorCode::buildSchedule(const unsigned char *matrix, unsigned int rows,
+        unsigned int columns, Schedule &schedule) {
+    const unsigned int inputs = columns * W;
+    const unsigned int outputs = rows * W;
+    vector<vector<bool> > bits(outputs, vector<bool>(inputs));
+    for (unsigned int r = 0; r < rows; ++r) {
+        for (unsigned int c = 0; c < columns; ++c) {
+            for (unsigned int i = 0; i < W; ++i) {
+                for (unsigned int j = 0; j < W; ++j) {
+                    bits[r * W + i][c * W + j] = bit(matrix[r * columns + c], i, j);
+                }
+            }
+        }
+    }
+    vector<unsigned int> cost(outputs, 0);
+    vector<int> from(outputs, -1);
+    vector<bool> done(outputs, false);
+    for (unsigned int o = 0; o < outputs; ++o) {
+        for (unsigned int b = 0; b < inputs; ++b) {
+            cost[o] += bits[o][b];
+        }
+    }
+    schedule.m_inputs = inputs;
+    schedule.m_ops.clear();
+    for (unsigned int n = 0; n < outputs; ++n) {
+        unsigned int o = outputs;
+        for (unsigned int p = 0; p < outputs; ++p) {
+            if (!done[p] && (o == outputs || cost[p] < cost[o])) {
+                o = p;
+            }
+        }
+        Operation op;
+        op.m_dst = o;
+        op.m_xor = false;
+        if (from[o] >= 0) {
+            op.m_src = inputs + from[o];
+            schedule.m_ops.push_back(op);
+            op.m_xor = true;
+        }
+        for (unsigned int b = 0; b < inputs; ++b) {
+            if (from[o] >= 0 ? (bits[o][b] != bits[from[o]][b]) : bits[o][b]) {
+                op.m_src = b;
+                schedule.m_ops.push_back(op);
+                op.m_xor = true;
+            }
+        }
+        done[o] = true;
+        for (unsigned int p = 0; p < outputs; ++p) {
+            if (done[p]) {
+                continue;
+            }
+            unsigned int c = 1;
+            for (unsigned int b = 0; b < inputs; ++b) {
+                c += bits[p][b] != bits[o][b];
+            }
+            if (c < cost[p]) {
+                cost[p] = c;
+                from[p] = o;
+            }
+        }
+    }
+}
+
+void RSxorCode::run(const Schedule &schedule, const unsigned char * const *src,
+        unsigned char * const *dst, size_t shardSize) const {
+    const XOR_FUNC xorFunc = getXorFunc();
+    const size_t unit = W * m_packetSize;
+    for (size_t offset = 0; offset < shardSize; offset += unit) {
+        size_t len = m_packetSize;
+        if (shardSize - offset < unit) {
+            len = (shardSize - offset) / W;
+        }
+        for (size_t n = 0; n < schedule.m_ops.size(); ++n) {
+            const Operation &op = schedule.m_ops[n];
+            const unsigned char *s;
+            if (op.m_src < schedule.m_inputs) {
+                s = src[op.m_src / W] + offset + (op.m_src % W) * len;
+            } else {
+                unsigned int row = op.m_src - schedule.m_inputs;
+                s = dst[row / W] + offset + (row % W) * len;
+            }
+            unsigned char *d = dst[op.m_dst / W] + offset + (op.m_dst % W) * len;
+            if (op.m_xor) {
+                xorFunc(d, s, len);
+            } else {
+                memcpy(d, s, len);
+            }
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * RSxorCode.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef RSXORCODE_HH_
+#define RSXORCODE_HH_
+
+#include <vector>
+#include <memory>
+
+#include "GF28Value.hh"
+#include "RScode.hh"
+#include "LRUCache.hh"
+
+/* XOR only Reed-Solomon code over GF(2^8) (Cauchy bit-matrix code).
+ * Multiplying by a coefficient c is linear over GF(2): bit i of c*x is the
+ * xor of the bits j of x for which bit i of c*2^j is set, so every
+ * coefficient is a 8x8 bit matrix. A shard is cut into units of 8 packets
+ * (packet j holds bit j of the unit's symbols), and the code only xors
+ * whole packets, which needs no table lookups at all.
+ * The Cauchy matrix is scaled by rows and columns (which keeps it MDS) to
+ * have as few ones as possible. Every output packet is then computed either
+ * from scratch or from an output packet computed before, whichever needs
+ * fewer xors, and the resulting schedule is reused for every unit.
+ * The encoding schedule is built once, decoding schedules are cached by
+ * erasure pattern like RScode's decoding matrices.
+ * The FEC shards differ from RScode's, they must be decoded by RSxorCode.
+ * As with RScode, the const methods can be called from any number of
+ * threads, each with its own Context; the methods without a Context use
+ * the code's own and print their errors.
+ *  */
+class RSxorCode {
+private:
+    struct Schedule;
+
+public:
+    typedef RScode<GF28Value>::Shard Shard;
+    typedef RScode<GF28Value>::E_RSCODE_STS E_RSCODE_STS;
+    /* RScode's Context with the decoding schedule of the last pattern,
+     * looked up before the shared cache as RScode does with its rows */
+    struct Context: public RScode<GF28Value>::Context {
+        std::vector<unsigned int> m_scheduleIndex;
+        std::shared_ptr<const Schedule> m_schedule;
+        unsigned long long m_scheduleCode = 0;      /* RSxorCode::m_id */
+    };
+    static const unsigned int W = 8;                /* Packets per unit */
+    static const size_t PACKET_SIZE = 1024;         /* Default packet size */
+
+public:
+    /* packetSize is rounded up to a multiple of 64 */
+    RSxorCode(unsigned int dataCount, unsigned int parityCount,
+            size_t packetSize = PACKET_SIZE);
+    ~RSxorCode();
+    RSxorCode(const RSxorCode &) = delete;
+    RSxorCode& operator=(const RSxorCode &) = delete;
+
+    /* data[0..dataCount-1] are the data shards, parity[0..parityCount-1]
+     * receive the FEC shards, every shard is shardSize bytes (a multiple
+     * of W). A short last unit has packets of (shardSize % (W x packetSize)) / W
+     * bytes. */
+    E_RSCODE_STS encode(const unsigned char * const *data,
+            unsigned char * const *parity, size_t shardSize) const;
+    /* Scatter/gather decoding, the same interface as RScode::decode:
+     * shard indices are 0..dataCount-1 for data and dataCount.. for FEC
+     * shards, data[i] receives the missing data line i. */
+    int decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize);
+    E_RSCODE_STS decode(const Shard *shards, unsigned int shardCount,
+            unsigned char * const *data, size_t shardSize, Context &ctx) const;
+
+    /* GF(2^8) coefficient of FEC row r and data column j */
+    unsigned char coefficient(unsigned int r, unsigned int j) const;
+    /* Packet operations (copies and xors) per unit of encoding */
+    inline size_t encodeOperations(void) const {
+        return m_encode.m_ops.size();
+    }
+    void setDecodeCacheSize(size_t size) {
+        if (m_pDecodeCache) {
+            m_pDecodeCache->setCapacity(size);
+        }
+    }
+    unsigned long long decodeCacheHits(void) const {
+        return m_pDecodeCache ? m_pDecodeCache->hits() : 0;
+    }
+    unsigned long long decodeCacheMisses(void) const {
+        return m_pDecodeCache ? m_pDecodeCache->misses() : 0;
+    }
+
+    /* Status of the construction or of the last call without Context */
+    inline E_RSCODE_STS error(void) const {return m_error;};
+    inline unsigned int dataCount(void) const {return m_dataCount;};
+    inline unsigned int parityCount(void) const {return m_parityCount;};
+    inline size_t packetSize(void) const {return m_packetSize;};
+
+private:
+    /* Packet rows are numbered shard x W + packet. Sources below m_inputs are
+     * input rows, the others are output rows (m_src - m_inputs). */
+    struct Operation {
+        unsigned int m_src;
+        unsigned int m_dst;                 /* Output row */
+        bool m_xor;                         /* dst ^= src, otherwise dst = src */
+    };
+    struct Schedule {
+        std::vector<unsigned int> m_missing;    /* Decoded data lines */
+        unsigned int m_inputs;                  /* Input rows */
+        std::vector<Operation> m_ops;
+    };
+    typedef std::shared_ptr<const Schedule> SCHEDULE;
+    typedef LRUCache<std::vector<unsigned int>, Schedule> SCHEDULE_CACHE;
+
+    static void buildSchedule(const unsigned char *matrix, unsigned int rows,
+            unsigned int columns, Schedule &schedule);
+    const Schedule* decodeSchedule(const std::vector<unsigned int> &index,
+            Context &ctx) const;
+    SCHEDULE buildDecodeSchedule(const std::vector<unsigned int> &index) const;
+    inline E_RSCODE_STS status(Context &ctx, E_RSCODE_STS sts) const {
+        ctx.m_error = sts;
+        return sts;
+    }
+    int report(E_RSCODE_STS sts);
+    void run(const Schedule &schedule, const unsigned char * const *src,
+            unsigned char * const *dst, size_t shardSize) const;
+
+private:
+    static const size_t DECODE_CACHE_SIZE = 64;
+    unsigned int m_dataCount;
+    unsigned int m_parityCount;
+    size_t m_packetSize;
+    std::vector<unsigned char> m_matrix;        /* parityCount x dataCount coefficients */
+    Schedule m_encode;                          /* Encoding schedule */
+    Context m_context;                          /* Of the calls without Context */
+    SCHEDULE_CACHE *m_pDecodeCache = NULL;      /* Decoding schedules by index array */
+    unsigned long long m_id = 0;                /* Owner of the schedules kept in Contexts */
+    E_RSCODE_STS m_state = RScode<GF28Value>::e_rscode_sts_init;    /* Construction */
+    E_RSCODE_STS m_error = RScode<GF28Value>::e_rscode_sts_init;
+};
+
+#endif /* RSXORCODE_HH_ */
@@ -0,0 +1,148 @@
+/*
+ * ThreadPool.cc
+ *
+ *  Created on: 2026/10/18
+ */
+
+#include "ThreadPool.hh"
+
+using namespace std;
+
+/* Pool and queue of the current worker thread */
+static thread_local const ThreadPool *s_pool = NULL;
+static thread_local unsigned int s_index = 0;
+
+ThreadPool::ThreadPool(unsigned int threadCount) :
+        m_next(0), m_pending(0), m_stop(false) {
+    if (threadCount == 0) {
+        threadCount = thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+    }
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_queues.push_back(new _QUEUE);
+    }
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_threads.push_back(thread(&ThreadPool::worker, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (unsigned int i = 0; i < m_threads.size(); ++i) {
+        m_threads[i].join();
+    }
+    for (unsigned int i = 0; i < m_queues.size(); ++i) {
+        delete m_queues[i];
+    }
+}
+
+void ThreadPool::submit(const TASK &task) {
+    unsigned int index;
+    if (s_pool == this) {
+        index = s_index;
+    } else {
+        index = m_next.fetch_add(1, memory_order_relaxed) % m_queues.size();
+    }
+    {
+        lock_guard<mutex> lock(m_queues[index]->m_mutex);
+        m_queues[index]->m_tasks.push_back(task);
+    }
+    {
+        lock_guard<mutex> lock(m_mutex);
+        ++m_pending;
+    }
+    m_cond.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count,
+        const function<void(size_t)> &func) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        func(0);
+        return;
+    }
+    struct {
+        mutex m_mutex;
+        condition_variable m_cond;
+        size_t m_remaining;
+    } group;
+    group.m_remaining = count;
+    function<void(size_t)> run = [&group, &func](size_t i) {
+        func(i);
+        lock_guard<mutex> lock(group.m_mutex);
+        if (--group.m_remaining == 0) {
+            group.m_cond.notify_all();
+        }
+    };
+    for (size_t i = 1; i < count; ++i) {
+        submit(bind(run, i));
+    }
+    run(0);
+    /* Help the workers until the queues are empty, then wait */
+    unsigned int index = (s_pool == this) ? s_index : 0;
+    TASK task;
+    while (steal(index, task)) {
+        task();
+    }
+    unique_lock<mutex> lock(group.m_mutex);
+    group.m_cond.wait(lock, [&group] { return group.m_remaining == 0; });
+}
+
+void ThreadPool::worker(unsigned int index) {
+    s_pool = this;
+    s_index = index;
+    for (;;) {
+        TASK task;
+        if (pop(index, task) || steal(index, task)) {
+            task();
+            continue;
+        }
+        unique_lock<mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return m_stop || m_pending > 0; });
+        if (m_stop && m_pending == 0) {
+            return;
+        }
+    }
+}
+
+/* Newest task of own queue */
+bool ThreadPool::pop(unsigned int index, TASK &task) {
+    {
+        lock_guard<mutex> lock(m_queues[index]->m_mutex);
+        if (m_queues[index]->m_tasks.empty()) {
+            return false;
+        }
+        task = m_queues[index]->m_tasks.back();
+        m_queues[index]->m_tasks.pop_back();
+    }
+    lock_guard<mutex> lock(m_mutex);
+    --m_pending;
+    return true;
+}
+
+/* Oldest task of any queue, starting from the one after index */
+bool ThreadPool::steal(unsigned int index, TASK &task) {
+    for (unsigned int i = 1; i <= m_queues.size(); ++i) {
+        _QUEUE *q = m_queues[(index + i) % m_queues.size()];
+        {
+            lock_guard<mutex> lock(q->m_mutex);
+            if (q->m_tasks.empty()) {
+                continue;
+            }
+            task = q->m_tasks.front();
+            q->m_tasks.pop_front();
+        }
+        lock_guard<mutex> lock(m_mutex);
+        --m_pending;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+/*
+ * ThreadPool.hh
+ *
+ *  Created on: 2026/10/18
+ */
+
+#ifndef THREADPOOL_HH_
+#define THREADPOOL_HH_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+/* Work-stealing thread pool.
+ * Every worker has its own task queue. A worker takes the newest task of
+ * its own queue and, when that is empty, steals the oldest task of another
+ * queue. Tasks submitted by a worker go to its own queue, other tasks are
+ * spread over the queues in turn.
+ *  */
+class ThreadPool {
+public:
+    typedef std::function<void(void)> TASK;
+
+public:
+    /* threadCount 0 means one thread per hardware thread */
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    inline unsigned int size(void) const {
+        return m_threads.size();
+    }
+    void submit(const TASK &task);
+    /* Run func(0), ..., func(count - 1) on the pool and wait for all of them.
+     * The calling thread runs tasks too while it waits, so parallelFor can
+     * be called from a task. */
+    void parallelFor(size_t count, const std::function<void(size_t)> &func);
+
+private:
+    struct _QUEUE {
+        std::mutex m_mutex;
+        std::deque<TASK> m_tasks;
+    };
+    void worker(unsigned int index);
+    bool pop(unsigned int index, TASK &task);
+    bool steal(unsigned int index, TASK &task);
+
+private:
+    std::vector<std::thread> m_threads;
+    std::vector<_QUEUE*> m_queues;              /* One queue per worker */
+    std::atomic<unsigned int> m_next;           /* Queue of next external submit */
+    std::mutex m_mutex;                         /* Guards m_pending and m_stop for m_cond */
+    std::condition_variable m_cond;
+    size_t m_pending;                           /* Queued tasks */
+    bool m_stop;
+};
+
+#endif /* THREADPOOL_HH_ */